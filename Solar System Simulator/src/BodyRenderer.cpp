@@ -0,0 +1,132 @@
+#include "BodyRenderer.h"
+#include "TextureLoader.h"
+#include <algorithm>
+#include <cstddef>
+
+BodyRenderer::BodyRenderer() : sphere(nullptr), instanceVBO(0), instanceCapacity(0), textureArray(0) {}
+
+// Builds the texture array from the bodies' textures and adds the instance attributes to the sphere VAO
+void BodyRenderer::create(const vector<CelestialBody*>& bodies, Model& sphereModel) {
+    sphere = &sphereModel;
+
+    // One layer per distinct texture
+    vector<GLuint> textures;
+    textureLayers.clear();
+    for (const auto& body : bodies) {
+        if (!body->hasTexture || body->textureID == 0) continue;
+        if (textureLayers.count(body->textureID)) continue;
+
+        textureLayers[body->textureID] = (int)textures.size();
+        textures.push_back(body->textureID);
+    }
+
+    if (textureArray) glDeleteTextures(1, &textureArray);
+    textureArray = createTextureArray(textures, BODY_TEXTURE_WIDTH, BODY_TEXTURE_HEIGHT);
+
+    if (!instanceVBO) glGenBuffers(1, &instanceVBO);
+    instanceCapacity = 0;
+
+    glBindVertexArray(sphere->getVAO());
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // Model matrix takes four vec4 locations, then color and shadow
+    for (GLuint i = 0; i < 6; i++) {
+        glEnableVertexAttribArray(INSTANCE_ATTRIBUTE_LOCATION + i);
+        glVertexAttribDivisor(INSTANCE_ATTRIBUTE_LOCATION + i, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BodyRenderer::destroy() {
+    if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
+    if (textureArray) glDeleteTextures(1, &textureArray);
+    instanceVBO = 0;
+    instanceCapacity = 0;
+    textureArray = 0;
+    textureLayers.clear();
+}
+
+BodyInstance BodyRenderer::makeInstance(CelestialBody* body) const {
+    BodyInstance instance;
+    instance.model = body->getModelMatrix();
+
+    float layer = -1.0f;
+    if (body->hasTexture) {
+        auto it = textureLayers.find(body->textureID);
+        if (it != textureLayers.end()) layer = (float)it->second;
+    }
+    instance.color = glm::vec4(body->renderColor, layer);
+
+    float intensity = body->renderInShadow ? body->renderShadowIntensity : 1.0f;
+    instance.shadow = glm::vec4(body->renderShadowDirection, intensity);
+    return instance;
+}
+
+// Sends this frame's instances in one write, growing the buffer when needed
+void BodyRenderer::uploadInstances() {
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    GLsizeiptr count = (GLsizeiptr)instances.size();
+    if (count > instanceCapacity) {
+        instanceCapacity = max(count, instanceCapacity * 2);
+    }
+
+    // Fresh storage every frame, so the driver doesn't wait for last frame's draws
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(BodyInstance), NULL, GL_STREAM_DRAW);
+
+    if (count > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(BodyInstance), instances.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Points the instance attributes at one material class and draws it
+void BodyRenderer::drawRange(Shader* shader, size_t first, size_t count) {
+    if (count == 0) return;
+
+    shader->use();
+
+    glBindVertexArray(sphere->getVAO());
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    size_t base = first * sizeof(BodyInstance);
+    GLsizei stride = sizeof(BodyInstance);
+    for (GLuint i = 0; i < 4; i++) {
+        glVertexAttribPointer(INSTANCE_ATTRIBUTE_LOCATION + i, 4, GL_FLOAT, GL_FALSE, stride,
+            (void*)(base + offsetof(BodyInstance, model) + i * sizeof(glm::vec4)));
+    }
+    glVertexAttribPointer(INSTANCE_ATTRIBUTE_LOCATION + 4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(BodyInstance, color)));
+    glVertexAttribPointer(INSTANCE_ATTRIBUTE_LOCATION + 5, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(BodyInstance, shadow)));
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    sphere->createInstanced((GLsizei)count);
+}
+
+void BodyRenderer::draw(const vector<CelestialBody*>& bodies, Shader* starShader, Shader* planetShader) {
+    if (!sphere) return;
+
+    // Stars first, then everything else
+    instances.clear();
+    instances.reserve(bodies.size());
+    for (const auto& body : bodies) {
+        if (body->isStar()) instances.push_back(makeInstance(body));
+    }
+    size_t starCount = instances.size();
+    for (const auto& body : bodies) {
+        if (!body->isStar()) instances.push_back(makeInstance(body));
+    }
+
+    uploadInstances();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+
+    drawRange(starShader, 0, starCount);
+    drawRange(planetShader, starCount, instances.size() - starCount);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
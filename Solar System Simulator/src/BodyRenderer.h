@@ -0,0 +1,51 @@
+#ifndef BODY_RENDERER_H
+#define BODY_RENDERER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include "CelestialBody.h"
+#include "Shader.h"
+#include "Model.h"
+
+using namespace std;
+
+// Size of every layer of the body texture array
+const int BODY_TEXTURE_WIDTH = 2048;
+const int BODY_TEXTURE_HEIGHT = 1024;
+
+// First attribute location of the per-instance data in the planet and star shaders
+const GLuint INSTANCE_ATTRIBUTE_LOCATION = 3;
+
+// Per-instance attributes of one body
+struct BodyInstance {
+    glm::mat4 model;
+    glm::vec4 color; // Texture layer in w, negative if untextured
+    glm::vec4 shadow; // Shadow direction in xyz, intensity in w, 1 when lit
+};
+
+// Draws every body with one instanced draw call per material class (stars, planets)
+class BodyRenderer {
+public:
+    BodyRenderer();
+
+    void create(const vector<CelestialBody*>& bodies, Model& sphere);
+    // Deletes the instance buffer and texture array, the GL context has to be current
+    void destroy();
+    void draw(const vector<CelestialBody*>& bodies, Shader* starShader, Shader* planetShader);
+
+private:
+    Model* sphere;
+    GLuint instanceVBO;
+    GLsizeiptr instanceCapacity; // Instances the buffer can hold
+    GLuint textureArray;
+    unordered_map<GLuint, int> textureLayers; // Body texture name -> array layer
+    vector<BodyInstance> instances; // Stars first, then planets, reused every frame
+
+    BodyInstance makeInstance(CelestialBody* body) const;
+    void uploadInstances();
+    void drawRange(Shader* shader, size_t first, size_t count);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "BodyStore.h"
+#include <algorithm>
+
+using namespace std;
+
+#if PHYSICS_PRECISION == PRECISION_FLOAT
+BodyStore::BodyStore() : forcePredicted(false), nextId(0) {}
+#else
+BodyStore::BodyStore() : nextId(0) {}
+#endif
+
+int BodyStore::addBody(glm::vec3 position, glm::vec3 velocity, float massValue, float radiusValue, unsigned int bodyFlags) {
+    int id = nextId++;
+
+    x.push_back(position.x);
+    y.push_back(position.y);
+    z.push_back(position.z);
+    vx.push_back(velocity.x);
+    vy.push_back(velocity.y);
+    vz.push_back(velocity.z);
+    ax.push_back(0.0f);
+    ay.push_back(0.0f);
+    az.push_back(0.0f);
+    mass.push_back(massValue);
+    radius.push_back(radiusValue);
+    flags.push_back(bodyFlags);
+    ids.push_back(id);
+
+    idToIndex.push_back(static_cast<int>(ids.size()) - 1);
+    return id;
+}
+
+void BodyStore::clear() {
+    x.clear(); y.clear(); z.clear();
+    vx.clear(); vy.clear(); vz.clear();
+    ax.clear(); ay.clear(); az.clear();
+    mass.clear();
+    radius.clear();
+    flags.clear();
+    ids.clear();
+    idToIndex.clear();
+    nextId = 0;
+    syncForcePositions();
+}
+
+void BodyStore::reserve(int count) {
+    x.reserve(count); y.reserve(count); z.reserve(count);
+    vx.reserve(count); vy.reserve(count); vz.reserve(count);
+    ax.reserve(count); ay.reserve(count); az.reserve(count);
+    mass.reserve(count);
+    radius.reserve(count);
+    flags.reserve(count);
+    ids.reserve(count);
+    idToIndex.reserve(count);
+}
+
+int BodyStore::size() const {
+    return static_cast<int>(ids.size());
+}
+
+int BodyStore::indexOf(int id) const {
+    if (id < 0 || id >= static_cast<int>(idToIndex.size())) return -1;
+    return idToIndex[id];
+}
+
+glm::vec3 BodyStore::getPosition(int i) const {
+    return glm::vec3(static_cast<float>(x[i]), static_cast<float>(y[i]), static_cast<float>(z[i]));
+}
+
+glm::vec3 BodyStore::getVelocity(int i) const {
+    return glm::vec3(static_cast<float>(vx[i]), static_cast<float>(vy[i]), static_cast<float>(vz[i]));
+}
+
+glm::vec3 BodyStore::getAcceleration(int i) const {
+    return glm::vec3(ax[i], ay[i], az[i]);
+}
+
+void BodyStore::setPosition(int i, const glm::vec3& position) {
+    x[i] = position.x;
+    y[i] = position.y;
+    z[i] = position.z;
+}
+
+void BodyStore::setVelocity(int i, const glm::vec3& velocity) {
+    vx[i] = velocity.x;
+    vy[i] = velocity.y;
+    vz[i] = velocity.z;
+}
+
+void BodyStore::addDisplacement(int i, const glm::vec3& displacement) {
+    x[i] += displacement.x;
+    y[i] += displacement.y;
+    z[i] += displacement.z;
+}
+
+void BodyStore::addVelocity(int i, const glm::vec3& change) {
+    vx[i] += change.x;
+    vy[i] += change.y;
+    vz[i] += change.z;
+}
+
+void BodyStore::addAcceleration(int i, const glm::vec3& acceleration) {
+    ax[i] += acceleration.x;
+    ay[i] += acceleration.y;
+    az[i] += acceleration.z;
+}
+
+void BodyStore::resetAccelerations() {
+    fill(ax.begin(), ax.end(), 0.0f);
+    fill(ay.begin(), ay.end(), 0.0f);
+    fill(az.begin(), az.end(), 0.0f);
+}
+
+bool BodyStore::isStatic(int i) const {
+    return (flags[i] & BODY_STATIC) != 0;
+}
+
+glm::vec3 BodyStore::getForcePosition(int i) const {
+    return glm::vec3(forceX()[i], forceY()[i], forceZ()[i]);
+}
+
+void BodyStore::predictForcePositions(const vector<float>& driftTimes) {
+    int count = size();
+    forcePositionX.resize(count);
+    forcePositionY.resize(count);
+    forcePositionZ.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        PhysicsReal driftTime = driftTimes[i];
+        forcePositionX[i] = static_cast<float>(x[i] + vx[i] * driftTime);
+        forcePositionY[i] = static_cast<float>(y[i] + vy[i] * driftTime);
+        forcePositionZ[i] = static_cast<float>(z[i] + vz[i] * driftTime);
+    }
+
+#if PHYSICS_PRECISION == PRECISION_FLOAT
+    forcePredicted = true;
+#endif
+}
+
+#if PHYSICS_PRECISION == PRECISION_FLOAT
+
+void BodyStore::syncForcePositions() {
+    forcePredicted = false;
+}
+
+const float* BodyStore::forceX() const { return forcePredicted ? forcePositionX.data() : x.data(); }
+const float* BodyStore::forceY() const { return forcePredicted ? forcePositionY.data() : y.data(); }
+const float* BodyStore::forceZ() const { return forcePredicted ? forcePositionZ.data() : z.data(); }
+
+#else
+
+void BodyStore::syncForcePositions() {
+    int count = size();
+    forcePositionX.resize(count);
+    forcePositionY.resize(count);
+    forcePositionZ.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        forcePositionX[i] = static_cast<float>(x[i]);
+        forcePositionY[i] = static_cast<float>(y[i]);
+        forcePositionZ[i] = static_cast<float>(z[i]);
+    }
+}
+
+const float* BodyStore::forceX() const { return forcePositionX.data(); }
+const float* BodyStore::forceY() const { return forcePositionY.data(); }
+const float* BodyStore::forceZ() const { return forcePositionZ.data(); }
+
+#endif
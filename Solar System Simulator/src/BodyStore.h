@@ -0,0 +1,73 @@
+#ifndef BODYSTORE_H
+#define BODYSTORE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "Precision.h"
+
+using namespace std;
+
+// Body flags
+const unsigned int BODY_STATIC = 1 << 0; // Never moved by the integrator
+const unsigned int BODY_STAR = 1 << 1;   // Lights the scene, planets bounce off it
+const unsigned int BODY_MOON = 1 << 2;   // Held in orbit around its parent body
+
+// Physics state of every body stored as separate contiguous arrays (structure of arrays).
+// Index i in every array belongs to the same body; ids[i] is its stable ID
+class BodyStore {
+public:
+    vector<PhysicsReal> x, y, z;    // Precision set by the PHYSICS_PRECISION policy
+    vector<PhysicsReal> vx, vy, vz;
+    vector<float> ax, ay, az;
+    vector<float> mass;
+    vector<float> radius;
+    vector<unsigned int> flags;
+    vector<int> ids;
+
+    BodyStore();
+
+    // Appends a body and returns its stable ID
+    int addBody(glm::vec3 position, glm::vec3 velocity, float massValue, float radiusValue, unsigned int bodyFlags);
+    void clear();
+    void reserve(int count);
+
+    int size() const;
+    int indexOf(int id) const;
+
+    glm::vec3 getPosition(int i) const;
+    glm::vec3 getVelocity(int i) const;
+    glm::vec3 getAcceleration(int i) const;
+    void setPosition(int i, const glm::vec3& position);
+    void setVelocity(int i, const glm::vec3& velocity);
+    // Changes applied to the state in its own precision, the setters above round double state to float
+    void addDisplacement(int i, const glm::vec3& displacement);
+    void addVelocity(int i, const glm::vec3& change);
+    void addAcceleration(int i, const glm::vec3& acceleration);
+
+    void resetAccelerations();
+    bool isStatic(int i) const;
+
+    // Float positions read by the force calculation, the state itself unless it is kept in double or predicted.
+    // Call syncForcePositions or predictForcePositions after moving bodies and before using them
+    void syncForcePositions();
+    const float* forceX() const;
+    const float* forceY() const;
+    const float* forceZ() const;
+    glm::vec3 getForcePosition(int i) const;
+
+    // Force positions moved ahead along the velocity by driftTimes[i], for bodies part way through their own step
+    void predictForcePositions(const vector<float>& driftTimes);
+
+private:
+    vector<float> forcePositionX, forcePositionY, forcePositionZ;
+#if PHYSICS_PRECISION == PRECISION_FLOAT
+    bool forcePredicted; // Force positions come from the arrays above instead of the state
+#endif
+
+    vector<int> idToIndex;
+    int nextId;
+
+    friend class Checkpoint;
+};
+
+#endif
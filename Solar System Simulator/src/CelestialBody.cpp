@@ -2,14 +2,18 @@
 
 using namespace std;
 
-CelestialBody::CelestialBody(glm::vec3 pos, glm::vec3 vel, float massValue, float radiusValue, glm::vec3 col,
-                            string n, bool staticBody, CelestialBody* parent)
-                            : position(pos), velocity(vel), mass(massValue), radius(radiusValue), color(col), name(n),
-                            isStatic(staticBody), parentBody(parent) {
-    acceleration = glm::vec3(0.0f);
+CelestialBody::CelestialBody(BodyStore& bodyStore, glm::vec3 pos, glm::vec3 vel, float massValue, float radiusValue, glm::vec3 col,
+                            string n, unsigned int bodyFlags, CelestialBody* parent)
+                            : store(&bodyStore), color(col), name(n), parentBody(parent) {
+    id = bodyStore.addBody(pos, vel, massValue, radiusValue, bodyFlags);
     rotationAngle = 0.0f;
     rotationSpeed = 0.5f;
     rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+    previousPosition = pos;
+    renderPosition = pos;
+    renderVelocity = vel;
+    renderRadius = radiusValue;
+    renderColor = col;
     hasTexture = false;
     textureID = 0;
     isOrbitingParent = (parent != nullptr);
@@ -17,10 +21,14 @@ CelestialBody::CelestialBody(glm::vec3 pos, glm::vec3 vel, float massValue, floa
     isInShadow = false;
     shadowIntensity = 1.0f;
     shadowDirection = glm::vec3(0.0f);
+    renderRotationAngle = 0.0f;
+    renderInShadow = false;
+    renderShadowIntensity = 1.0f;
+    renderShadowDirection = glm::vec3(0.0f);
 
     isColliding = false;
     collisionTimer = 0.0f;
-    originalRadius = radius;
+    originalRadius = radiusValue;
     originalColor = color;
 
     hasRings = false;
@@ -29,29 +37,59 @@ CelestialBody::CelestialBody(glm::vec3 pos, glm::vec3 vel, float massValue, floa
     ringTextureID = 0;
 }
 
-void CelestialBody::updatePosition(float deltaTime) {
-    if (isStatic) return;
+int CelestialBody::index() const {
+    return store->indexOf(id);
+}
 
-    updateCollisionAnimation(deltaTime);
+glm::vec3 CelestialBody::getPosition() const {
+    return store->getPosition(index());
+}
 
-    // Using semi - implicit Euler integration for orbital stability
-    velocity += acceleration * deltaTime;
-    position += velocity * deltaTime;
+glm::vec3 CelestialBody::getVelocity() const {
+    return store->getVelocity(index());
+}
 
-    rotationAngle += rotationSpeed * deltaTime;
-    if (rotationAngle > 360.0f) rotationAngle -= 360.0f;
+float CelestialBody::getMass() const {
+    return store->mass[index()];
+}
+
+float CelestialBody::getRadius() const {
+    return store->radius[index()];
+}
 
-    addOrbitPoint();
+bool CelestialBody::isStatic() const {
+    return store->isStatic(index());
 }
 
-void CelestialBody::resetAcceleration() {
-    acceleration = glm::vec3(0.0f);
+bool CelestialBody::isStar() const {
+    return (store->flags[index()] & BODY_STAR) != 0;
+}
+
+bool CelestialBody::isMoon() const {
+    return (store->flags[index()] & BODY_MOON) != 0;
+}
+
+void CelestialBody::setPosition(const glm::vec3& pos) {
+    store->setPosition(index(), pos);
+}
+
+void CelestialBody::setVelocity(const glm::vec3& vel) {
+    store->setVelocity(index(), vel);
+}
+
+void CelestialBody::updateVisualState(float deltaTime) {
+    if (isStatic()) return;
+
+    updateCollisionAnimation(deltaTime);
+
+    rotationAngle += rotationSpeed * deltaTime;
+    if (rotationAngle > 360.0f) rotationAngle -= 360.0f;
 }
 
-void CelestialBody::addOrbitPoint() {
-    if (isStatic || name == "Sun") return;
+void CelestialBody::addOrbitPoint(const glm::vec3& point) {
+    if (isStatic() || isStar()) return;
 
-    orbitPoints.push_back(position);
+    orbitPoints.push_back(point);
 
     // Trail orbit length
     if (orbitPoints.size() > 4000) {
@@ -63,22 +101,51 @@ void CelestialBody::clearOrbit() {
     orbitPoints.clear();
 }
 
+void CelestialBody::storePreviousPosition() {
+    previousPosition = getPosition();
+}
+
+void CelestialBody::applySnapshot(const BodySnapshot& snapshot, float alpha) {
+    renderPosition = glm::mix(snapshot.previousPosition, snapshot.position, alpha);
+    renderVelocity = snapshot.velocity;
+    renderRadius = snapshot.radius;
+    renderColor = snapshot.color;
+    renderRotationAngle = snapshot.rotationAngle;
+    renderInShadow = snapshot.isInShadow;
+    renderShadowIntensity = snapshot.shadowIntensity;
+    renderShadowDirection = snapshot.shadowDirection;
+}
+
 glm::mat4 CelestialBody::getModelMatrix() {
     glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
+    model = glm::translate(model, renderPosition);
     
     if (rotationSpeed > 0.0f && glm::length(rotationAxis) > 0.0f) {
-        model = glm::rotate(model, glm::radians(rotationAngle), rotationAxis);
+        model = glm::rotate(model, glm::radians(renderRotationAngle), rotationAxis);
     }
 
-    model = glm::scale(model, glm::vec3(radius));
+    model = glm::scale(model, glm::vec3(renderRadius));
     return model;
 }
 
+void CelestialBody::resetVisualState() {
+    rotationAngle = 0.0f;
+    previousPosition = getPosition();
+
+    isInShadow = false;
+    shadowIntensity = 1.0f;
+    shadowDirection = glm::vec3(0.0f);
+
+    isColliding = false;
+    collisionTimer = 0.0f;
+    originalRadius = getRadius();
+    color = originalColor;
+}
+
 void CelestialBody::startCollisionAnimation() {
     isColliding = true;
     collisionTimer = 2.0f; // 2 second animation
-    originalRadius = radius;
+    originalRadius = getRadius();
 }
 
 // Collision animation
@@ -90,7 +157,7 @@ void CelestialBody::updateCollisionAnimation(float deltaTime) {
             // Pulsing effect: size oscillates during collision
             float pulse = sin(collisionTimer * 20.0f) * 0.2f + 1.0f; // Pulsating size increase
 
-            radius = originalRadius * pulse;
+            store->radius[index()] = originalRadius * pulse;
 
             // Color shift to red during collision, then back to original
             color = glm::mix(glm::vec3(1.0f, 0.3f, 0.3f), originalColor, 1.0f - collisionTimer);
@@ -98,7 +165,7 @@ void CelestialBody::updateCollisionAnimation(float deltaTime) {
         else {
             // End of animation
             isColliding = false;
-            radius = originalRadius;
+            store->radius[index()] = originalRadius;
             color = originalColor;
         }
     }
@@ -1,35 +1,46 @@
 #ifndef CELESTIALBODY_H
 #define CELESTIALBODY_H
 
-#include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <string>
+#include "BodyStore.h"
+#include "SimulationSnapshot.h"
 
 using namespace std;
 
+// Rendering and bookkeeping data of a body. Position, velocity, mass and radius live in the BodyStore
 class CelestialBody {
 public:
     // Physical properties
-    glm::vec3 position;
-    glm::vec3 velocity;
-    glm::vec3 acceleration;
-    float mass;
-    float radius;
+    BodyStore* store;
+    int id; // Stable ID in the store
 
     // Visual properties
     glm::vec3 color;
     string name;
     bool hasTexture;
-    GLuint textureID;
+    unsigned int textureID; // OpenGL texture name, 0 if none
 
     // Simulation properties
-    bool isStatic;
     float rotationAngle;
     float rotationSpeed;
     glm::vec3 rotationAxis;
 
+    // Position before the last physics step
+    glm::vec3 previousPosition;
+
+    // What is drawn, copied from the latest physics snapshot on the render thread
+    glm::vec3 renderPosition;
+    glm::vec3 renderVelocity;
+    float renderRadius;
+    glm::vec3 renderColor;
+    float renderRotationAngle;
+    bool renderInShadow;
+    float renderShadowIntensity;
+    glm::vec3 renderShadowDirection;
+
     // Orbit tracking
     vector<glm::vec3> orbitPoints;
 
@@ -52,18 +63,40 @@ public:
     bool hasRings;
     float ringInnerRadius;
     float ringOuterRadius;
-    GLuint ringTextureID;
+    unsigned int ringTextureID;
+
+    CelestialBody(BodyStore& bodyStore, glm::vec3 pos, glm::vec3 vel, float m, float r, glm::vec3 col,
+                  string n, unsigned int bodyFlags = 0, CelestialBody* parent = nullptr);
+
+    int index() const;
+    glm::vec3 getPosition() const;
+    glm::vec3 getVelocity() const;
+    float getMass() const;
+    float getRadius() const;
+    bool isStatic() const;
+    bool isStar() const;
+    bool isMoon() const;
+    void setPosition(const glm::vec3& pos);
+    void setVelocity(const glm::vec3& vel);
 
-    CelestialBody(glm::vec3 pos, glm::vec3 vel, float m, float r, glm::vec3 col,
-                  string n, bool staticBody = false, CelestialBody* parent = nullptr);
+    // Rotation and collision animation, run after the physics step
+    void updateVisualState(float deltaTime);
 
-    void updatePosition(float deltaTime);
-    void resetAcceleration();
-    void addOrbitPoint();
+    // Orbit trail, kept by the render thread
+    void addOrbitPoint(const glm::vec3& point);
     void clearOrbit();
 
+    // Call before each physics step
+    void storePreviousPosition();
+
+    // Render thread: takes over a snapshot, alpha is how far the frame is into the next step
+    void applySnapshot(const BodySnapshot& snapshot, float alpha);
+
     glm::mat4 getModelMatrix();
 
+    // Back to how the body looked when created, used when the simulation is reset
+    void resetVisualState();
+
     void startCollisionAnimation();
     void updateCollisionAnimation(float deltaTime);
 };
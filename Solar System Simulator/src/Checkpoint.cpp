@@ -0,0 +1,449 @@
+#include "Checkpoint.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char CHECKPOINT_MAGIC[8] = { 'S', 'S', 'S', 'C', 'H', 'K', 'P', 'T' };
+
+// Fixed size start of every checkpoint, the sections follow in the order they are written below
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t totalSize;     // Whole image, a shorter file was cut off while writing
+    uint64_t checksum;      // FNV-1a of everything after the header
+    uint32_t bodyCount;
+    uint32_t realSize;      // sizeof(PhysicsReal), 4 or 8
+    int32_t nextId;
+    uint32_t levelCount;    // Block timestep entries, 0 when block timesteps never ran
+    uint64_t trailPointCount;
+    double simulationTime;
+    int64_t forceEvaluations;
+
+    // Engine settings
+    int32_t gravityMode;
+    int32_t gravityKernel;
+    int32_t integrator;
+    int32_t blockTimesteps;
+    int32_t threadCount;
+    float openingAngle;
+    float lastCollisionTime;
+    uint32_t hasTrails;
+};
+
+// Animation and shadow state of one body, which feeds back into the radius in the store
+struct CheckpointBodyState {
+    float rotationAngle;
+    float collisionTimer;
+    float originalRadius;
+    float color[3];
+    float shadowIntensity;
+    float shadowDirection[3];
+    uint32_t isColliding;
+    uint32_t isInShadow;
+    uint32_t trailLength;
+    uint32_t nameLength;
+};
+
+static size_t paddedSize(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+template <typename T>
+static void appendArray(vector<char>& image, const T* data, size_t count) {
+    size_t offset = image.size();
+    size_t bytes = count * sizeof(T);
+
+    image.resize(offset + paddedSize(bytes), 0);
+    if (bytes > 0) memcpy(image.data() + offset, data, bytes);
+}
+
+// Walks the sections of an image, every read fails once one went past the end
+class ImageReader {
+public:
+    ImageReader(const vector<char>& image, size_t start) : image(image), offset(start), ok(true) {}
+
+    template <typename T>
+    const char* take(size_t count) {
+        size_t bytes = paddedSize(count * sizeof(T));
+        if (!ok || offset + bytes > image.size()) {
+            ok = false;
+            return nullptr;
+        }
+
+        const char* data = image.data() + offset;
+        offset += bytes;
+        return data;
+    }
+
+    template <typename T>
+    bool read(vector<T>& out, size_t count) {
+        const char* data = take<T>(count);
+        if (!data) return false;
+
+        out.resize(count);
+        if (count > 0) memcpy(out.data(), data, count * sizeof(T));
+        return true;
+    }
+
+    bool valid() const { return ok; }
+
+private:
+    const vector<char>& image;
+    size_t offset;
+    bool ok;
+};
+
+static uint64_t checksumOf(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void Checkpoint::serialize(const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine,
+                           bool includeTrails, vector<char>& image) {
+    size_t count = store.ids.size();
+    size_t levelCount = engine.timestepLevels.size();
+
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.headerSize = sizeof(CheckpointHeader);
+    header.bodyCount = static_cast<uint32_t>(count);
+    header.realSize = sizeof(PhysicsReal);
+    header.nextId = store.nextId;
+    header.levelCount = static_cast<uint32_t>(levelCount);
+    header.simulationTime = engine.clock->now();
+    header.forceEvaluations = engine.forceEvaluations;
+    header.gravityMode = engine.gravityMode;
+    header.gravityKernel = engine.gravityKernel;
+    header.integrator = engine.integrator;
+    header.blockTimesteps = engine.blockTimesteps ? 1 : 0;
+    header.threadCount = engine.getThreadCount();
+    header.openingAngle = engine.openingAngle;
+    header.lastCollisionTime = engine.lastCollisionTime;
+    header.hasTrails = includeTrails ? 1 : 0;
+
+    image.clear();
+    appendArray(image, &header, 1);
+
+    // Store arrays
+    appendArray(image, store.x.data(), count);
+    appendArray(image, store.y.data(), count);
+    appendArray(image, store.z.data(), count);
+    appendArray(image, store.vx.data(), count);
+    appendArray(image, store.vy.data(), count);
+    appendArray(image, store.vz.data(), count);
+    appendArray(image, store.ax.data(), count);
+    appendArray(image, store.ay.data(), count);
+    appendArray(image, store.az.data(), count);
+    appendArray(image, store.mass.data(), count);
+    appendArray(image, store.radius.data(), count);
+    appendArray(image, store.flags.data(), count);
+    appendArray(image, store.ids.data(), count);
+
+    // Body state, written in place so there's no temporary array
+    size_t statesOffset = image.size();
+    image.resize(statesOffset + paddedSize(count * sizeof(CheckpointBodyState)), 0);
+
+    uint64_t trailPointCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        const CelestialBody* body = bodies[i];
+
+        CheckpointBodyState state;
+        memset(&state, 0, sizeof(state));
+        state.rotationAngle = body->rotationAngle;
+        state.collisionTimer = body->collisionTimer;
+        state.originalRadius = body->originalRadius;
+        state.color[0] = body->color.r;
+        state.color[1] = body->color.g;
+        state.color[2] = body->color.b;
+        state.shadowIntensity = body->shadowIntensity;
+        state.shadowDirection[0] = body->shadowDirection.x;
+        state.shadowDirection[1] = body->shadowDirection.y;
+        state.shadowDirection[2] = body->shadowDirection.z;
+        state.isColliding = body->isColliding ? 1 : 0;
+        state.isInShadow = body->isInShadow ? 1 : 0;
+        state.trailLength = includeTrails ? static_cast<uint32_t>(body->orbitPoints.size()) : 0;
+        state.nameLength = static_cast<uint32_t>(body->name.size());
+
+        memcpy(image.data() + statesOffset + i * sizeof(CheckpointBodyState), &state, sizeof(state));
+        trailPointCount += state.trailLength;
+    }
+
+    // Block timestep state
+    appendArray(image, engine.timestepLevels.data(), levelCount);
+    appendArray(image, engine.previousAx.data(), levelCount);
+    appendArray(image, engine.previousAy.data(), levelCount);
+    appendArray(image, engine.previousAz.data(), levelCount);
+
+    // Trails and names, each body's after the previous one's
+    if (includeTrails) {
+        for (const auto& body : bodies) {
+            size_t offset = image.size();
+            size_t bytes = body->orbitPoints.size() * sizeof(glm::vec3);
+            image.resize(offset + bytes);
+            if (bytes > 0) memcpy(image.data() + offset, body->orbitPoints.data(), bytes);
+        }
+        image.resize(paddedSize(image.size()), 0);
+    }
+
+    for (const auto& body : bodies) {
+        image.insert(image.end(), body->name.begin(), body->name.end());
+    }
+    image.resize(paddedSize(image.size()), 0);
+
+    // Sizes and checksum are only known now
+    CheckpointHeader* finalHeader = reinterpret_cast<CheckpointHeader*>(image.data());
+    finalHeader->trailPointCount = trailPointCount;
+    finalHeader->totalSize = image.size();
+    finalHeader->checksum = checksumOf(image.data() + sizeof(CheckpointHeader), image.size() - sizeof(CheckpointHeader));
+}
+
+bool Checkpoint::deserialize(const vector<char>& image, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine,
+                             bool restoreTrails, string& error) {
+    if (image.size() < sizeof(CheckpointHeader)) {
+        error = "file is too short";
+        return false;
+    }
+
+    CheckpointHeader header;
+    memcpy(&header, image.data(), sizeof(header));
+
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        error = "not a checkpoint";
+        return false;
+    }
+    if (header.version != CHECKPOINT_VERSION || header.headerSize != sizeof(CheckpointHeader)) {
+        error = "checkpoint version " + to_string(header.version) + " is not supported";
+        return false;
+    }
+    if (header.totalSize != image.size()) {
+        error = "checkpoint is incomplete";
+        return false;
+    }
+    if (header.checksum != checksumOf(image.data() + sizeof(CheckpointHeader), image.size() - sizeof(CheckpointHeader))) {
+        error = "checkpoint is corrupted";
+        return false;
+    }
+    if (header.realSize != sizeof(PhysicsReal)) {
+        error = "checkpoint was taken with a different PHYSICS_PRECISION";
+        return false;
+    }
+    if (header.bodyCount != bodies.size()) {
+        error = "checkpoint has " + to_string(header.bodyCount) + " bodies, the scene " + to_string(bodies.size());
+        return false;
+    }
+
+    size_t count = header.bodyCount;
+    size_t levelCount = header.levelCount;
+    ImageReader reader(image, sizeof(CheckpointHeader));
+
+    // Everything is read into a scratch store first so a bad file changes nothing
+    BodyStore restored;
+    reader.read(restored.x, count);
+    reader.read(restored.y, count);
+    reader.read(restored.z, count);
+    reader.read(restored.vx, count);
+    reader.read(restored.vy, count);
+    reader.read(restored.vz, count);
+    reader.read(restored.ax, count);
+    reader.read(restored.ay, count);
+    reader.read(restored.az, count);
+    reader.read(restored.mass, count);
+    reader.read(restored.radius, count);
+    reader.read(restored.flags, count);
+    reader.read(restored.ids, count);
+
+    const char* statesData = reader.take<CheckpointBodyState>(count);
+
+    vector<int> levels;
+    vector<float> previousAx, previousAy, previousAz;
+    reader.read(levels, levelCount);
+    reader.read(previousAx, levelCount);
+    reader.read(previousAy, levelCount);
+    reader.read(previousAz, levelCount);
+
+    const char* trailData = header.trailPointCount > 0 ? reader.take<glm::vec3>(header.trailPointCount) : nullptr;
+
+    if (!reader.valid()) {
+        error = "checkpoint sections are cut off";
+        return false;
+    }
+
+    // Names have to match the scene body for body
+    vector<CheckpointBodyState> states(count);
+    if (count > 0) memcpy(states.data(), statesData, count * sizeof(CheckpointBodyState));
+
+    size_t nameBytes = 0;
+    for (const auto& state : states) nameBytes += state.nameLength;
+
+    const char* names = reader.take<char>(nameBytes);
+    if (!names) {
+        error = "checkpoint sections are cut off";
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        string name(names, states[i].nameLength);
+        names += states[i].nameLength;
+
+        if (name != bodies[i]->name || restored.ids[i] != bodies[i]->id) {
+            error = "body " + to_string(i) + " is " + name + " in the checkpoint but " + bodies[i]->name + " in the scene";
+            return false;
+        }
+    }
+
+    // Checked, now take it over. The store's arrays are swapped in whole
+    restored.nextId = header.nextId;
+    restored.idToIndex.assign(header.nextId, -1);
+    for (size_t i = 0; i < count; i++) {
+        int id = restored.ids[i];
+        if (id < 0 || id >= header.nextId) {
+            error = "checkpoint has an invalid body ID";
+            return false;
+        }
+        restored.idToIndex[id] = static_cast<int>(i);
+    }
+    swap(store, restored);
+
+    for (size_t i = 0; i < count; i++) {
+        CelestialBody* body = bodies[i];
+        const CheckpointBodyState& state = states[i];
+
+        body->rotationAngle = state.rotationAngle;
+        body->collisionTimer = state.collisionTimer;
+        body->originalRadius = state.originalRadius;
+        body->color = glm::vec3(state.color[0], state.color[1], state.color[2]);
+        body->shadowIntensity = state.shadowIntensity;
+        body->shadowDirection = glm::vec3(state.shadowDirection[0], state.shadowDirection[1], state.shadowDirection[2]);
+        body->isColliding = state.isColliding != 0;
+        body->isInShadow = state.isInShadow != 0;
+        body->previousPosition = body->getPosition();
+
+        if (restoreTrails && header.hasTrails) {
+            const glm::vec3* points = reinterpret_cast<const glm::vec3*>(trailData);
+            body->orbitPoints.assign(points, points + state.trailLength);
+            if (trailData) trailData += state.trailLength * sizeof(glm::vec3);
+        }
+    }
+
+    PhysicsSettings settings;
+    settings.gravityMode = static_cast<GravityMode>(header.gravityMode);
+    settings.openingAngle = header.openingAngle;
+    settings.gravityKernel = static_cast<GravityKernel>(header.gravityKernel);
+    settings.integrator = static_cast<Integrator>(header.integrator % INTEGRATOR_COUNT);
+    settings.blockTimesteps = header.blockTimesteps != 0;
+    settings.threadCount = header.threadCount;
+    engine.applySettings(settings);
+
+    // After the settings, changing the block mode clears the levels
+    engine.timestepLevels.swap(levels);
+    engine.previousAx.swap(previousAx);
+    engine.previousAy.swap(previousAy);
+    engine.previousAz.swap(previousAz);
+    engine.forceEvaluations = header.forceEvaluations;
+    engine.lastCollisionTime = header.lastCollisionTime;
+    engine.clock->reset(header.simulationTime);
+
+    return true;
+}
+
+bool Checkpoint::writeFile(const string& path, const vector<char>& image) {
+    string temporaryPath = path + ".tmp";
+
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) return false;
+
+    bool written = fwrite(image.data(), 1, image.size(), file) == image.size() && fflush(file) == 0;
+
+    // On the disk before it replaces the last good checkpoint, not only in the OS cache
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        remove(temporaryPath.c_str());
+        return false;
+    }
+
+    error_code renameError;
+    filesystem::rename(temporaryPath, path, renameError);
+    return !renameError;
+}
+
+bool Checkpoint::readFile(const string& path, vector<char>& image) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    bool read = fseek(file, 0, SEEK_END) == 0;
+    long size = read ? ftell(file) : -1;
+    read = read && size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+
+    if (read) {
+        image.resize(static_cast<size_t>(size));
+        read = fread(image.data(), 1, image.size(), file) == image.size();
+    }
+
+    fclose(file);
+    return read;
+}
+
+bool Checkpoint::save(const string& path, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine, bool includeTrails) {
+    vector<char> image;
+    serialize(store, bodies, engine, includeTrails, image);
+    return writeFile(path, image);
+}
+
+bool Checkpoint::load(const string& path, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine,
+                      bool restoreTrails, string& error) {
+    vector<char> image;
+    if (!readFile(path, image)) {
+        error = "could not read " + path;
+        return false;
+    }
+    return deserialize(image, store, bodies, engine, restoreTrails, error);
+}
+
+CheckpointWriter::CheckpointWriter() : current(0), lastWriteOk(true) {}
+
+CheckpointWriter::~CheckpointWriter() {
+    wait();
+}
+
+void CheckpointWriter::save(const string& path, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine, bool includeTrails) {
+    // The image not being written is free, fill it while the other one may still be going to disk
+    Checkpoint::serialize(store, bodies, engine, includeTrails, images[current]);
+
+    wait();
+
+    const vector<char>& image = images[current];
+    writer = thread([this, path, &image]() {
+        lastWriteOk = Checkpoint::writeFile(path, image);
+        if (!lastWriteOk) cout << "Could not write checkpoint " << path << endl;
+    });
+
+    current = 1 - current;
+}
+
+bool CheckpointWriter::wait() {
+    if (writer.joinable()) writer.join();
+    return lastWriteOk;
+}
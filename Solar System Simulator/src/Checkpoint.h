@@ -0,0 +1,60 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include "BodyStore.h"
+#include "CelestialBody.h"
+#include "PhysicsEngine.h"
+
+using namespace std;
+
+const unsigned int CHECKPOINT_VERSION = 1;
+
+// The complete simulation state as one flat binary image: a fixed header, then the store arrays,
+// per-body animation state, block timestep state, orbit trails and body names, each padded to 8 bytes.
+// Native byte order; files from another version or precision policy are rejected
+class Checkpoint {
+public:
+    // Flattens the state into 'image', which keeps its capacity so repeated checkpoints don't allocate
+    static void serialize(const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine,
+                          bool includeTrails, vector<char>& image);
+
+    // Loads an image into a scene with the same bodies, the scene the checkpoint was taken from rebuilt.
+    // Trails are left alone unless asked for, they may belong to another thread.
+    // Returns false and leaves the state untouched if the image doesn't fit
+    static bool deserialize(const vector<char>& image, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine,
+                            bool restoreTrails, string& error);
+
+    // The whole image in one write, through a temporary file so a crash never leaves half a checkpoint behind
+    static bool writeFile(const string& path, const vector<char>& image);
+    static bool readFile(const string& path, vector<char>& image);
+
+    // Serialize and write, or read and deserialize, on the calling thread
+    static bool save(const string& path, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine, bool includeTrails);
+    static bool load(const string& path, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine,
+                     bool restoreTrails, string& error);
+};
+
+// Takes checkpoints without waiting for the disk: the state is copied on the calling thread
+// and written by a background thread while the simulation carries on
+class CheckpointWriter {
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    // Only waits if the previous checkpoint is still being written
+    void save(const string& path, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine, bool includeTrails);
+
+    // Blocks until the last checkpoint is on disk, false if writing it failed
+    bool wait();
+
+private:
+    vector<char> images[2]; // One being filled while the other is written
+    int current;
+    thread writer;
+    bool lastWriteOk;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "FixedStepScheduler.h"
+#include <algorithm>
+
+using namespace std;
+
+FixedStepScheduler::FixedStepScheduler(double stepDelta, int maxStepsPerFrame)
+    : stepDelta(stepDelta), accumulator(0.0), droppedTime(0.0), maxStepsPerFrame(maxStepsPerFrame) {}
+
+void FixedStepScheduler::setStepDelta(double delta) {
+    if (delta > 0.0) stepDelta = delta;
+    accumulator = min(accumulator, stepDelta);
+}
+
+double FixedStepScheduler::getStepDelta() const {
+    return stepDelta;
+}
+
+void FixedStepScheduler::setMaxStepsPerFrame(int maxSteps) {
+    maxStepsPerFrame = max(1, maxSteps);
+}
+
+int FixedStepScheduler::getMaxStepsPerFrame() const {
+    return maxStepsPerFrame;
+}
+
+int FixedStepScheduler::advance(double simulatedDelta) {
+    accumulator += max(0.0, simulatedDelta);
+
+    int steps = static_cast<int>(accumulator / stepDelta);
+
+    // A stalled frame would otherwise ask for a burst of steps that makes the next frame slow too
+    if (steps > maxStepsPerFrame) {
+        double excess = accumulator - maxStepsPerFrame * stepDelta;
+        double kept = excess - static_cast<int>(excess / stepDelta) * stepDelta;
+
+        droppedTime += excess - kept;
+        accumulator = maxStepsPerFrame * stepDelta + kept;
+        steps = maxStepsPerFrame;
+    }
+
+    accumulator -= steps * stepDelta;
+    return steps;
+}
+
+float FixedStepScheduler::getInterpolation() const {
+    return static_cast<float>(min(1.0, accumulator / stepDelta));
+}
+
+double FixedStepScheduler::getDroppedTime() const {
+    return droppedTime;
+}
+
+void FixedStepScheduler::reset() {
+    accumulator = 0.0;
+    droppedTime = 0.0;
+}
@@ -0,0 +1,35 @@
+#ifndef FIXEDSTEPSCHEDULER_H
+#define FIXEDSTEPSCHEDULER_H
+
+// Turns variable frame times into a whole number of fixed physics steps.
+// Leftover time is carried to the next frame and used to interpolate what is drawn
+class FixedStepScheduler {
+public:
+    FixedStepScheduler(double stepDelta = 0.02, int maxStepsPerFrame = 16);
+
+    void setStepDelta(double delta);
+    double getStepDelta() const;
+
+    // Catch-up budget: time that would need more steps than this in one frame is dropped instead
+    void setMaxStepsPerFrame(int maxSteps);
+    int getMaxStepsPerFrame() const;
+
+    // Adds simulated time and returns how many steps to run now
+    int advance(double simulatedDelta);
+
+    // How far between the last two physics states the current time is, 0 to 1
+    float getInterpolation() const;
+
+    // Simulated time thrown away because the catch-up budget ran out
+    double getDroppedTime() const;
+
+    void reset();
+
+private:
+    double stepDelta;
+    double accumulator;
+    double droppedTime;
+    int maxStepsPerFrame;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "FrameUniformBuffer.h"
+
+static_assert(sizeof(FrameData) == 176, "FrameData must match the std140 layout");
+
+FrameUniformBuffer::FrameUniformBuffer() : UBO(0), data() {}
+
+void FrameUniformBuffer::create() {
+    if (UBO) return;
+
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // The buffer stays bound to its binding point for the whole run
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, UBO);
+}
+
+void FrameUniformBuffer::destroy() {
+    if (UBO) glDeleteBuffers(1, &UBO);
+    UBO = 0;
+}
+
+// Points the shader's FrameData block at the shared binding point
+void FrameUniformBuffer::attach(Shader* shader) const {
+    if (!shader->bindUniformBlock(FRAME_UNIFORM_BLOCK, FRAME_UNIFORM_BINDING)) {
+        cout << "Shader " << shader->getID() << " has no " << FRAME_UNIFORM_BLOCK << " block" << endl;
+    }
+}
+
+void FrameUniformBuffer::update(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& lightPos,
+    const glm::vec3& lightColor, const glm::vec3& viewPos) {
+    data.projection = projection;
+    data.view = view;
+    data.lightPos = glm::vec4(lightPos, 1.0f);
+    data.lightColor = glm::vec4(lightColor, 1.0f);
+    data.viewPos = glm::vec4(viewPos, 1.0f);
+
+    // Whole block rewritten once per frame
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,40 @@
+#ifndef FRAME_UNIFORM_BUFFER_H
+#define FRAME_UNIFORM_BUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+
+using namespace std;
+
+// Block name and binding point shared by every shader that reads frame data
+const char* const FRAME_UNIFORM_BLOCK = "FrameData";
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+// Mirrors the std140 FrameData block, vec3 members are padded to 16 bytes
+struct FrameData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+    glm::vec4 viewPos;
+};
+
+// Camera and lighting data uploaded once per frame and shared by all programs
+class FrameUniformBuffer {
+public:
+    FrameUniformBuffer();
+
+    void create();
+    // Call while the GL context still exists, the instance outlives it as a global
+    void destroy();
+    void attach(Shader* shader) const;
+    void update(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& lightPos,
+        const glm::vec3& lightColor, const glm::vec3& viewPos);
+
+private:
+    GLuint UBO;
+    FrameData data;
+};
+
+#endif
\ No newline at end of file
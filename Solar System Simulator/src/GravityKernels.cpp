@@ -0,0 +1,225 @@
+#include "GravityKernels.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(GRAVITY_KERNELS_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+void gravityScalar(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az) {
+    for (int i = begin; i < end; i++) {
+        float xi = sources.x[i];
+        float yi = sources.y[i];
+        float zi = sources.z[i];
+        float massI = sources.mass[i];
+        bool iIsSun = (i == sources.sun);
+
+        float sumX = 0.0f;
+        float sumY = 0.0f;
+        float sumZ = 0.0f;
+
+        for (int j = i + 1; j < sources.count; j++) {
+            float dx = sources.x[j] - xi;
+            float dy = sources.y[j] - yi;
+            float dz = sources.z[j] - zi;
+            float distSq = dx * dx + dy * dy + dz * dz;
+
+            if (distSq < sources.minDistanceSq) continue;
+
+            float invDist = 1.0f / sqrt(distSq);
+            float weight = pairWeight(iIsSun || j == sources.sun, distSq, invDist);
+            float strength = sources.G * invDist * invDist * invDist * weight;
+
+            // Equal and opposite forces, so each side is scaled by the other body's mass
+            float strengthI = strength * sources.mass[j];
+            float strengthJ = strength * massI;
+
+            sumX += dx * strengthI;
+            sumY += dy * strengthI;
+            sumZ += dz * strengthI;
+
+            ax[j] -= dx * strengthJ;
+            ay[j] -= dy * strengthJ;
+            az[j] -= dz * strengthJ;
+        }
+
+        ax[i] += sumX;
+        ay[i] += sumY;
+        az[i] += sumZ;
+    }
+}
+
+void gravityGather(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az) {
+    for (int t = 0; t < targetCount; t++) {
+        int i = targets[t];
+        float xi = sources.x[i];
+        float yi = sources.y[i];
+        float zi = sources.z[i];
+        bool iIsSun = (i == sources.sun);
+
+        float sumX = 0.0f;
+        float sumY = 0.0f;
+        float sumZ = 0.0f;
+
+        for (int j = 0; j < sources.count; j++) {
+            float dx = sources.x[j] - xi;
+            float dy = sources.y[j] - yi;
+            float dz = sources.z[j] - zi;
+            float distSq = dx * dx + dy * dy + dz * dz;
+
+            if (j == i || distSq < sources.minDistanceSq) continue;
+
+            float invDist = 1.0f / sqrt(distSq);
+            float weight = pairWeight(iIsSun || j == sources.sun, distSq, invDist);
+            float strength = sources.G * sources.mass[j] * invDist * invDist * invDist * weight;
+
+            sumX += dx * strength;
+            sumY += dy * strength;
+            sumZ += dz * strength;
+        }
+
+        ax[i] += sumX;
+        ay[i] += sumY;
+        az[i] += sumZ;
+    }
+}
+
+void runGravityKernel(GravityKernel kernel, const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az) {
+    switch (kernel) {
+    case KERNEL_AVX512:
+        gravityAVX512(sources, begin, end, ax, ay, az);
+        break;
+    case KERNEL_AVX2:
+        gravityAVX2(sources, begin, end, ax, ay, az);
+        break;
+    default:
+        gravityScalar(sources, begin, end, ax, ay, az);
+        break;
+    }
+}
+
+void runGatherKernel(GravityKernel kernel, const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az) {
+    switch (kernel) {
+    case KERNEL_AVX512:
+        gravityGatherAVX512(sources, targets, targetCount, ax, ay, az);
+        break;
+    case KERNEL_AVX2:
+        gravityGatherAVX2(sources, targets, targetCount, ax, ay, az);
+        break;
+    default:
+        gravityGather(sources, targets, targetCount, ax, ay, az);
+        break;
+    }
+}
+
+int pairRowSplit(int count, int part, int parts) {
+    if (part <= 0) return 0;
+    if (part >= parts) return count;
+
+    // Rows 0..r-1 hold r * (2 * count - r - 1) / 2 pairs, solve for the row where the share is reached
+    double n = count;
+    double pairs = n * (n - 1.0) / 2.0 * part / parts;
+    double b = 2.0 * n - 1.0;
+    double row = (b - sqrt(b * b - 8.0 * pairs)) / 2.0;
+
+    return min(count, max(0, static_cast<int>(row + 0.5)));
+}
+
+glm::vec3 pairAcceleration(const GravitySources& sources, int i, int j) {
+    glm::vec3 dir(sources.x[j] - sources.x[i], sources.y[j] - sources.y[i], sources.z[j] - sources.z[i]);
+    float distSq = glm::dot(dir, dir);
+
+    if (i == j || distSq < sources.minDistanceSq) return glm::vec3(0.0f);
+
+    float invDist = 1.0f / sqrt(distSq);
+    float weight = pairWeight(i == sources.sun || j == sources.sun, distSq, invDist);
+
+    return dir * (sources.G * sources.mass[j] * invDist * invDist * invDist * weight);
+}
+
+#ifdef GRAVITY_KERNELS_X86
+
+#ifdef _MSC_VER
+static void cpuid(int info[4], int leaf) {
+    __cpuidex(info, leaf, 0);
+}
+
+static unsigned long long readXCR0() {
+    return _xgetbv(0);
+}
+#else
+#include <cpuid.h>
+
+static void cpuid(int info[4], int leaf) {
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, 0, a, b, c, d);
+    info[0] = a; info[1] = b; info[2] = c; info[3] = d;
+}
+
+static unsigned long long readXCR0() {
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+#endif
+
+// The CPU has to support the instructions and the OS has to save the wide registers
+static bool detectAVX2() {
+    int info[4];
+    cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    cpuid(info, 1);
+    bool osSaves = (info[2] & (1 << 27)) != 0;
+    bool hasAVX = (info[2] & (1 << 28)) != 0;
+    bool hasFMA = (info[2] & (1 << 12)) != 0;
+    if (!osSaves || !hasAVX || !hasFMA) return false;
+    if ((readXCR0() & 0x6) != 0x6) return false;
+
+    cpuid(info, 7);
+    return (info[1] & (1 << 5)) != 0;
+}
+
+static bool detectAVX512() {
+    if (!detectAVX2()) return false;
+    if ((readXCR0() & 0xE6) != 0xE6) return false;
+
+    int info[4];
+    cpuid(info, 7);
+    return (info[1] & (1 << 16)) != 0;
+}
+
+#else
+
+static bool detectAVX2() { return false; }
+static bool detectAVX512() { return false; }
+
+#endif
+
+bool isKernelSupported(GravityKernel kernel) {
+    static const bool hasAVX2 = detectAVX2();
+    static const bool hasAVX512 = detectAVX512();
+
+    switch (kernel) {
+    case KERNEL_AVX512: return hasAVX512;
+    case KERNEL_AVX2: return hasAVX2;
+    default: return true;
+    }
+}
+
+GravityKernel detectBestKernel() {
+    if (isKernelSupported(KERNEL_AVX512)) return KERNEL_AVX512;
+    if (isKernelSupported(KERNEL_AVX2)) return KERNEL_AVX2;
+    return KERNEL_SCALAR;
+}
+
+const char* getKernelName(GravityKernel kernel) {
+    switch (kernel) {
+    case KERNEL_AVX512: return "AVX-512";
+    case KERNEL_AVX2: return "AVX2";
+    default: return "Scalar";
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef GRAVITYKERNELS_H
+#define GRAVITYKERNELS_H
+
+#include <glm/glm.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GRAVITY_KERNELS_X86 1
+#endif
+
+enum GravityKernel {
+    KERNEL_SCALAR = 0,
+    KERNEL_AVX2 = 1,   // 8 interactions per instruction
+    KERNEL_AVX512 = 2  // 16 interactions per instruction
+};
+
+const float CLOSE_ENCOUNTER_DISTANCE = 7.0f; // Planets closer than this pull harder
+const float CLOSE_ENCOUNTER_BOOST = 200.0f;  // Pull multiplier is CLOSE_ENCOUNTER_BOOST / distance
+
+// Packed body arrays read by the direct-sum kernels
+struct GravitySources {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* mass;
+    int count;
+    int sun;             // Index of the Sun, -1 if there is none
+    float G;
+    float minDistanceSq; // Pairs closer than this are ignored
+};
+
+// Weight of the pull between two bodies, the same from both sides.
+// Inside the close encounter distance planets pull each other harder, the Sun never does
+inline float pairWeight(bool sunPair, float distSq, float invDist) {
+    if (sunPair || distSq >= CLOSE_ENCOUNTER_DISTANCE * CLOSE_ENCOUNTER_DISTANCE) return 1.0f;
+    return CLOSE_ENCOUNTER_BOOST * invDist;
+}
+
+// Each kernel visits every pair (i, j) with i in [begin, end) and j > i once,
+// adding the pull to body i and the equal and opposite pull to body j
+void gravityScalar(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az);
+void gravityAVX2(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az);
+void gravityAVX512(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az);
+
+void runGravityKernel(GravityKernel kernel, const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az);
+
+// Adds the pull of every source to each listed target only, for when just some bodies need new forces
+void gravityGather(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az);
+void gravityGatherAVX2(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az);
+void gravityGatherAVX512(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az);
+
+void runGatherKernel(GravityKernel kernel, const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az);
+
+// First row of part 'part' when the j > i triangle of 'count' bodies is split into 'parts' with about the same number of pairs
+int pairRowSplit(int count, int part, int parts);
+
+// Pull of body j on body i using the same rules as the kernels
+glm::vec3 pairAcceleration(const GravitySources& sources, int i, int j);
+
+// Runtime CPU dispatch
+bool isKernelSupported(GravityKernel kernel);
+GravityKernel detectBestKernel();
+const char* getKernelName(GravityKernel kernel);
+
+#endif
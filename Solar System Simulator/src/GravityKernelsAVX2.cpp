@@ -0,0 +1,193 @@
+// Compiled with AVX2 code generation; only called after isKernelSupported(KERNEL_AVX2)
+#include "GravityKernels.h"
+
+#ifdef GRAVITY_KERNELS_X86
+
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include <immintrin.h>
+
+struct TargetAVX2 {
+    __m256 x, y, z, mass;
+    __m256 sunPair; // All lanes set when the target is the Sun
+};
+
+struct ConstantsAVX2 {
+    __m256 G, minDistSq, closeSq, boost, one, half, threeHalves;
+    __m256i sun, laneOffsets;
+};
+
+// Pairs body i with the 8 sources starting at j. The pull on i is added to sum, the opposite pull on
+// each j is returned in pullJ; lanes past the end of the arrays must be masked off in 'lanes'
+static inline void accumulateAVX2(const TargetAVX2& target, const ConstantsAVX2& c, int j,
+                                  __m256 xj, __m256 yj, __m256 zj, __m256 massJ, __m256 lanes,
+                                  __m256& sumX, __m256& sumY, __m256& sumZ,
+                                  __m256& pullX, __m256& pullY, __m256& pullZ) {
+    __m256 dx = _mm256_sub_ps(xj, target.x);
+    __m256 dy = _mm256_sub_ps(yj, target.y);
+    __m256 dz = _mm256_sub_ps(zj, target.z);
+    __m256 distSq = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)));
+
+    // 1/r from the reciprocal square root estimate and one Newton-Raphson step
+    __m256 invDist = _mm256_rsqrt_ps(distSq);
+    __m256 halfDistSq = _mm256_mul_ps(c.half, distSq);
+    invDist = _mm256_mul_ps(invDist, _mm256_fnmadd_ps(halfDistSq, _mm256_mul_ps(invDist, invDist), c.threeHalves));
+    __m256 invDist3 = _mm256_mul_ps(invDist, _mm256_mul_ps(invDist, invDist));
+
+    // Same rules as pairWeight
+    __m256i index = _mm256_add_epi32(_mm256_set1_epi32(j), c.laneOffsets);
+    __m256 sunPair = _mm256_or_ps(target.sunPair, _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, c.sun)));
+    __m256 boosted = _mm256_andnot_ps(sunPair, _mm256_cmp_ps(distSq, c.closeSq, _CMP_LT_OQ));
+    __m256 weight = _mm256_blendv_ps(c.one, _mm256_mul_ps(c.boost, invDist), boosted);
+
+    __m256 valid = _mm256_and_ps(lanes, _mm256_cmp_ps(distSq, c.minDistSq, _CMP_GE_OQ));
+    __m256 strength = _mm256_and_ps(valid, _mm256_mul_ps(c.G, _mm256_mul_ps(invDist3, weight)));
+
+    __m256 strengthI = _mm256_mul_ps(strength, massJ);
+    __m256 strengthJ = _mm256_mul_ps(strength, target.mass);
+
+    sumX = _mm256_fmadd_ps(dx, strengthI, sumX);
+    sumY = _mm256_fmadd_ps(dy, strengthI, sumY);
+    sumZ = _mm256_fmadd_ps(dz, strengthI, sumZ);
+
+    pullX = _mm256_mul_ps(dx, strengthJ);
+    pullY = _mm256_mul_ps(dy, strengthJ);
+    pullZ = _mm256_mul_ps(dz, strengthJ);
+}
+
+static inline float horizontalSumAVX2(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+static ConstantsAVX2 makeConstantsAVX2(const GravitySources& sources) {
+    ConstantsAVX2 c;
+    c.G = _mm256_set1_ps(sources.G);
+    c.minDistSq = _mm256_set1_ps(sources.minDistanceSq);
+    c.closeSq = _mm256_set1_ps(CLOSE_ENCOUNTER_DISTANCE * CLOSE_ENCOUNTER_DISTANCE);
+    c.boost = _mm256_set1_ps(CLOSE_ENCOUNTER_BOOST);
+    c.one = _mm256_set1_ps(1.0f);
+    c.half = _mm256_set1_ps(0.5f);
+    c.threeHalves = _mm256_set1_ps(1.5f);
+    c.sun = _mm256_set1_epi32(sources.sun);
+    c.laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    return c;
+}
+
+void gravityAVX2(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az) {
+    const ConstantsAVX2 c = makeConstantsAVX2(sources);
+
+    const int count = sources.count;
+    const __m256 allLanes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (int i = begin; i < end; i++) {
+        TargetAVX2 target;
+        target.x = _mm256_set1_ps(sources.x[i]);
+        target.y = _mm256_set1_ps(sources.y[i]);
+        target.z = _mm256_set1_ps(sources.z[i]);
+        target.mass = _mm256_set1_ps(sources.mass[i]);
+        target.sunPair = (i == sources.sun) ? allLanes : _mm256_setzero_ps();
+
+        __m256 sumX = _mm256_setzero_ps();
+        __m256 sumY = _mm256_setzero_ps();
+        __m256 sumZ = _mm256_setzero_ps();
+        __m256 pullX, pullY, pullZ;
+
+        int j = i + 1;
+        for (; j + 8 <= count; j += 8) {
+            accumulateAVX2(target, c, j,
+                           _mm256_loadu_ps(sources.x + j), _mm256_loadu_ps(sources.y + j),
+                           _mm256_loadu_ps(sources.z + j), _mm256_loadu_ps(sources.mass + j),
+                           allLanes, sumX, sumY, sumZ, pullX, pullY, pullZ);
+
+            _mm256_storeu_ps(ax + j, _mm256_sub_ps(_mm256_loadu_ps(ax + j), pullX));
+            _mm256_storeu_ps(ay + j, _mm256_sub_ps(_mm256_loadu_ps(ay + j), pullY));
+            _mm256_storeu_ps(az + j, _mm256_sub_ps(_mm256_loadu_ps(az + j), pullZ));
+        }
+
+        if (j < count) {
+            __m256i tailMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - j), c.laneOffsets);
+
+            accumulateAVX2(target, c, j,
+                           _mm256_maskload_ps(sources.x + j, tailMask), _mm256_maskload_ps(sources.y + j, tailMask),
+                           _mm256_maskload_ps(sources.z + j, tailMask), _mm256_maskload_ps(sources.mass + j, tailMask),
+                           _mm256_castsi256_ps(tailMask), sumX, sumY, sumZ, pullX, pullY, pullZ);
+
+            _mm256_maskstore_ps(ax + j, tailMask, _mm256_sub_ps(_mm256_maskload_ps(ax + j, tailMask), pullX));
+            _mm256_maskstore_ps(ay + j, tailMask, _mm256_sub_ps(_mm256_maskload_ps(ay + j, tailMask), pullY));
+            _mm256_maskstore_ps(az + j, tailMask, _mm256_sub_ps(_mm256_maskload_ps(az + j, tailMask), pullZ));
+        }
+
+        ax[i] += horizontalSumAVX2(sumX);
+        ay[i] += horizontalSumAVX2(sumY);
+        az[i] += horizontalSumAVX2(sumZ);
+    }
+}
+
+// Same pairs from the target's side only, nothing is written to the sources
+void gravityGatherAVX2(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az) {
+    const ConstantsAVX2 c = makeConstantsAVX2(sources);
+
+    const int count = sources.count;
+    const __m256 allLanes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (int t = 0; t < targetCount; t++) {
+        int i = targets[t];
+
+        TargetAVX2 target;
+        target.x = _mm256_set1_ps(sources.x[i]);
+        target.y = _mm256_set1_ps(sources.y[i]);
+        target.z = _mm256_set1_ps(sources.z[i]);
+        target.mass = _mm256_set1_ps(sources.mass[i]);
+        target.sunPair = (i == sources.sun) ? allLanes : _mm256_setzero_ps();
+
+        const __m256i self = _mm256_set1_epi32(i);
+
+        __m256 sumX = _mm256_setzero_ps();
+        __m256 sumY = _mm256_setzero_ps();
+        __m256 sumZ = _mm256_setzero_ps();
+        __m256 pullX, pullY, pullZ;
+
+        int j = 0;
+        for (; j + 8 <= count; j += 8) {
+            __m256i index = _mm256_add_epi32(_mm256_set1_epi32(j), c.laneOffsets);
+            __m256 lanes = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(index, self)), allLanes);
+
+            accumulateAVX2(target, c, j,
+                           _mm256_loadu_ps(sources.x + j), _mm256_loadu_ps(sources.y + j),
+                           _mm256_loadu_ps(sources.z + j), _mm256_loadu_ps(sources.mass + j),
+                           lanes, sumX, sumY, sumZ, pullX, pullY, pullZ);
+        }
+
+        if (j < count) {
+            __m256i index = _mm256_add_epi32(_mm256_set1_epi32(j), c.laneOffsets);
+            __m256i tailMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - j), c.laneOffsets);
+            __m256 lanes = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(index, self)), _mm256_castsi256_ps(tailMask));
+
+            accumulateAVX2(target, c, j,
+                           _mm256_maskload_ps(sources.x + j, tailMask), _mm256_maskload_ps(sources.y + j, tailMask),
+                           _mm256_maskload_ps(sources.z + j, tailMask), _mm256_maskload_ps(sources.mass + j, tailMask),
+                           lanes, sumX, sumY, sumZ, pullX, pullY, pullZ);
+        }
+
+        ax[i] += horizontalSumAVX2(sumX);
+        ay[i] += horizontalSumAVX2(sumY);
+        az[i] += horizontalSumAVX2(sumZ);
+    }
+}
+
+#else
+
+void gravityAVX2(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az) {
+    gravityScalar(sources, begin, end, ax, ay, az);
+}
+
+void gravityGatherAVX2(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az) {
+    gravityGather(sources, targets, targetCount, ax, ay, az);
+}
+
+#endif
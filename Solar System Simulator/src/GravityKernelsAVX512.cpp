@@ -0,0 +1,174 @@
+// Compiled with AVX-512 code generation; only called after isKernelSupported(KERNEL_AVX512)
+#include "GravityKernels.h"
+
+#ifdef GRAVITY_KERNELS_X86
+
+#if defined(__GNUC__) && !defined(__AVX512F__)
+#pragma GCC target("avx512f,avx2,fma")
+#endif
+
+#include <immintrin.h>
+
+struct TargetAVX512 {
+    __m512 x, y, z, mass;
+    __mmask16 sunPair; // All lanes set when the target is the Sun
+};
+
+struct ConstantsAVX512 {
+    __m512 G, minDistSq, closeSq, boost, one, half, threeHalves;
+    __m512i sun, laneOffsets;
+};
+
+// Pairs body i with the 16 sources starting at j. The pull on i is added to sum, the opposite pull on
+// each j is returned in pullJ; lanes outside 'lanes' are zero
+static inline void accumulateAVX512(const TargetAVX512& target, const ConstantsAVX512& c, int j,
+                                    __m512 xj, __m512 yj, __m512 zj, __m512 massJ, __mmask16 lanes,
+                                    __m512& sumX, __m512& sumY, __m512& sumZ,
+                                    __m512& pullX, __m512& pullY, __m512& pullZ) {
+    __m512 dx = _mm512_sub_ps(xj, target.x);
+    __m512 dy = _mm512_sub_ps(yj, target.y);
+    __m512 dz = _mm512_sub_ps(zj, target.z);
+    __m512 distSq = _mm512_fmadd_ps(dx, dx, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dz, dz)));
+
+    // 1/r from the 14-bit reciprocal square root estimate and one Newton-Raphson step
+    __m512 invDist = _mm512_rsqrt14_ps(distSq);
+    __m512 halfDistSq = _mm512_mul_ps(c.half, distSq);
+    invDist = _mm512_mul_ps(invDist, _mm512_fnmadd_ps(halfDistSq, _mm512_mul_ps(invDist, invDist), c.threeHalves));
+    __m512 invDist3 = _mm512_mul_ps(invDist, _mm512_mul_ps(invDist, invDist));
+
+    // Same rules as pairWeight
+    __m512i index = _mm512_add_epi32(_mm512_set1_epi32(j), c.laneOffsets);
+    __mmask16 sunPair = target.sunPair | _mm512_cmpeq_epi32_mask(index, c.sun);
+    __mmask16 boosted = _mm512_cmp_ps_mask(distSq, c.closeSq, _CMP_LT_OQ) & ~sunPair;
+    __m512 weight = _mm512_mask_mul_ps(c.one, boosted, c.boost, invDist);
+
+    __mmask16 valid = lanes & _mm512_cmp_ps_mask(distSq, c.minDistSq, _CMP_GE_OQ);
+    __m512 strength = _mm512_maskz_mul_ps(valid, c.G, _mm512_mul_ps(invDist3, weight));
+
+    __m512 strengthI = _mm512_mul_ps(strength, massJ);
+    __m512 strengthJ = _mm512_mul_ps(strength, target.mass);
+
+    sumX = _mm512_fmadd_ps(dx, strengthI, sumX);
+    sumY = _mm512_fmadd_ps(dy, strengthI, sumY);
+    sumZ = _mm512_fmadd_ps(dz, strengthI, sumZ);
+
+    pullX = _mm512_mul_ps(dx, strengthJ);
+    pullY = _mm512_mul_ps(dy, strengthJ);
+    pullZ = _mm512_mul_ps(dz, strengthJ);
+}
+
+static ConstantsAVX512 makeConstantsAVX512(const GravitySources& sources) {
+    ConstantsAVX512 c;
+    c.G = _mm512_set1_ps(sources.G);
+    c.minDistSq = _mm512_set1_ps(sources.minDistanceSq);
+    c.closeSq = _mm512_set1_ps(CLOSE_ENCOUNTER_DISTANCE * CLOSE_ENCOUNTER_DISTANCE);
+    c.boost = _mm512_set1_ps(CLOSE_ENCOUNTER_BOOST);
+    c.one = _mm512_set1_ps(1.0f);
+    c.half = _mm512_set1_ps(0.5f);
+    c.threeHalves = _mm512_set1_ps(1.5f);
+    c.sun = _mm512_set1_epi32(sources.sun);
+    c.laneOffsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return c;
+}
+
+void gravityAVX512(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az) {
+    const ConstantsAVX512 c = makeConstantsAVX512(sources);
+
+    const int count = sources.count;
+    const __mmask16 allLanes = 0xFFFF;
+
+    for (int i = begin; i < end; i++) {
+        TargetAVX512 target;
+        target.x = _mm512_set1_ps(sources.x[i]);
+        target.y = _mm512_set1_ps(sources.y[i]);
+        target.z = _mm512_set1_ps(sources.z[i]);
+        target.mass = _mm512_set1_ps(sources.mass[i]);
+        target.sunPair = (i == sources.sun) ? allLanes : 0;
+
+        __m512 sumX = _mm512_setzero_ps();
+        __m512 sumY = _mm512_setzero_ps();
+        __m512 sumZ = _mm512_setzero_ps();
+        __m512 pullX, pullY, pullZ;
+
+        int j = i + 1;
+        for (; j + 16 <= count; j += 16) {
+            accumulateAVX512(target, c, j,
+                             _mm512_loadu_ps(sources.x + j), _mm512_loadu_ps(sources.y + j),
+                             _mm512_loadu_ps(sources.z + j), _mm512_loadu_ps(sources.mass + j),
+                             allLanes, sumX, sumY, sumZ, pullX, pullY, pullZ);
+
+            _mm512_storeu_ps(ax + j, _mm512_sub_ps(_mm512_loadu_ps(ax + j), pullX));
+            _mm512_storeu_ps(ay + j, _mm512_sub_ps(_mm512_loadu_ps(ay + j), pullY));
+            _mm512_storeu_ps(az + j, _mm512_sub_ps(_mm512_loadu_ps(az + j), pullZ));
+        }
+
+        if (j < count) {
+            __mmask16 tailMask = static_cast<__mmask16>((1u << (count - j)) - 1u);
+
+            accumulateAVX512(target, c, j,
+                             _mm512_maskz_loadu_ps(tailMask, sources.x + j), _mm512_maskz_loadu_ps(tailMask, sources.y + j),
+                             _mm512_maskz_loadu_ps(tailMask, sources.z + j), _mm512_maskz_loadu_ps(tailMask, sources.mass + j),
+                             tailMask, sumX, sumY, sumZ, pullX, pullY, pullZ);
+
+            _mm512_mask_storeu_ps(ax + j, tailMask, _mm512_sub_ps(_mm512_maskz_loadu_ps(tailMask, ax + j), pullX));
+            _mm512_mask_storeu_ps(ay + j, tailMask, _mm512_sub_ps(_mm512_maskz_loadu_ps(tailMask, ay + j), pullY));
+            _mm512_mask_storeu_ps(az + j, tailMask, _mm512_sub_ps(_mm512_maskz_loadu_ps(tailMask, az + j), pullZ));
+        }
+
+        ax[i] += _mm512_reduce_add_ps(sumX);
+        ay[i] += _mm512_reduce_add_ps(sumY);
+        az[i] += _mm512_reduce_add_ps(sumZ);
+    }
+}
+
+// Same pairs from the target's side only, nothing is written to the sources
+void gravityGatherAVX512(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az) {
+    const ConstantsAVX512 c = makeConstantsAVX512(sources);
+
+    const int count = sources.count;
+    const __mmask16 allLanes = 0xFFFF;
+
+    for (int t = 0; t < targetCount; t++) {
+        int i = targets[t];
+
+        TargetAVX512 target;
+        target.x = _mm512_set1_ps(sources.x[i]);
+        target.y = _mm512_set1_ps(sources.y[i]);
+        target.z = _mm512_set1_ps(sources.z[i]);
+        target.mass = _mm512_set1_ps(sources.mass[i]);
+        target.sunPair = (i == sources.sun) ? allLanes : 0;
+
+        const __m512i self = _mm512_set1_epi32(i);
+
+        __m512 sumX = _mm512_setzero_ps();
+        __m512 sumY = _mm512_setzero_ps();
+        __m512 sumZ = _mm512_setzero_ps();
+        __m512 pullX, pullY, pullZ;
+
+        for (int j = 0; j < count; j += 16) {
+            __mmask16 lanes = count - j >= 16 ? allLanes : static_cast<__mmask16>((1u << (count - j)) - 1u);
+            lanes &= ~_mm512_cmpeq_epi32_mask(_mm512_add_epi32(_mm512_set1_epi32(j), c.laneOffsets), self);
+
+            accumulateAVX512(target, c, j,
+                             _mm512_maskz_loadu_ps(lanes, sources.x + j), _mm512_maskz_loadu_ps(lanes, sources.y + j),
+                             _mm512_maskz_loadu_ps(lanes, sources.z + j), _mm512_maskz_loadu_ps(lanes, sources.mass + j),
+                             lanes, sumX, sumY, sumZ, pullX, pullY, pullZ);
+        }
+
+        ax[i] += _mm512_reduce_add_ps(sumX);
+        ay[i] += _mm512_reduce_add_ps(sumY);
+        az[i] += _mm512_reduce_add_ps(sumZ);
+    }
+}
+
+#else
+
+void gravityAVX512(const GravitySources& sources, int begin, int end, float* ax, float* ay, float* az) {
+    gravityScalar(sources, begin, end, ax, ay, az);
+}
+
+void gravityGatherAVX512(const GravitySources& sources, const int* targets, int targetCount, float* ax, float* ay, float* az) {
+    gravityGather(sources, targets, targetCount, ax, ay, az);
+}
+
+#endif
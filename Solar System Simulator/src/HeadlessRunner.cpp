@@ -0,0 +1,337 @@
+// Steps the default scene without a window, for long integrations on machines with no display
+#include "PhysicsEngine.h"
+#include "SolarSystemScene.h"
+#include "Checkpoint.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryReader.h"
+#include "Profiler.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+// Final state of one run
+struct RunResult {
+    vector<string> names;
+    vector<glm::dvec3> positions;
+    double simulatedTime;
+    double seconds;
+    long long forceEvaluations;
+    bool ok;
+};
+
+// Files the main run reads and writes besides the positions
+struct RunOutputs {
+    string resumePath;              // Continue from this checkpoint instead of the start
+    string checkpointPath;          // Where checkpoints go
+    long long checkpointInterval;   // Steps between checkpoints, 0 only writes one at the end
+    string recordPath;              // Trajectory file
+    int recordInterval;             // Steps between recorded frames
+
+    RunOutputs() : checkpointInterval(0), recordInterval(1) {}
+};
+
+void printUsage() {
+    cout << "Usage: HeadlessRunner <steps> [options]" << endl;
+    cout << "  --dt <seconds>        Simulated time per step (default 0.016)" << endl;
+    cout << "  --threads <count>     Physics threads (default: one per hardware thread)" << endl;
+    cout << "  --integrator <0-3>    Euler, Leapfrog, Yoshida, Forest-Ruth (default Leapfrog)" << endl;
+    cout << "  --barnes-hut          Use the Barnes-Hut gravity solver" << endl;
+    cout << "  --block               Use individual block timesteps" << endl;
+    cout << "  --save <file>         Write the final positions, e.g. as the reference for --compare" << endl;
+    cout << "  --compare <file>      Report the position error against a saved run" << endl;
+    cout << "  --sweep <count>       Cost against accuracy: repeats the run with dt halved 'count' times over the same span" << endl;
+    cout << "  --checkpoint <file>   Write a checkpoint at the end, and every --checkpoint-every steps" << endl;
+    cout << "  --checkpoint-every <steps>  Steps between checkpoints" << endl;
+    cout << "  --resume <file>       Continue from a checkpoint, with the settings it was taken with" << endl;
+    cout << "  --record <file>       Record the trajectories of all bodies" << endl;
+    cout << "  --record-every <steps>  Steps between recorded frames (default 1)" << endl;
+    cout << "  --compare-trajectory <file>  Report the position error against a recorded run, interpolated to the same time" << endl;
+    cout << "  --trace <file>        Profile the physics phases and write them as a Chrome trace" << endl;
+    cout << "Precision is chosen at compile time with PHYSICS_PRECISION, this build uses " << getPrecisionName() << endl;
+}
+
+RunResult runScene(const PhysicsSettings& settings, float deltaTime, long long steps, const RunOutputs& outputs) {
+    BodyStore bodyStore;
+    vector<CelestialBody*> celestialBodies;
+    PhysicsEngine physicsEngine;
+    RunResult result;
+    result.ok = true;
+
+    physicsEngine.applySettings(settings);
+    buildSolarSystem(bodyStore, celestialBodies);
+    physicsEngine.resolveSpecialBodies(bodyStore, celestialBodies);
+
+    if (!outputs.resumePath.empty()) {
+        string error;
+        if (!Checkpoint::load(outputs.resumePath, bodyStore, celestialBodies, physicsEngine, true, error)) {
+            cout << "Could not resume: " << error << endl;
+            result.ok = false;
+        }
+        else {
+            cout << "Resumed from " << outputs.resumePath << " at " << physicsEngine.getClock().now() << "s" << endl;
+        }
+    }
+
+    CheckpointWriter checkpointWriter;
+    TrajectoryRecorder recorder;
+    if (!outputs.recordPath.empty() && result.ok) {
+        long long frames = steps / outputs.recordInterval + 1;
+        // A batch run wants every frame, it waits if the disk can't keep up
+        if (recorder.open(outputs.recordPath, bodyStore, celestialBodies, outputs.recordInterval, frames, false)) {
+            recorder.recordFrame(bodyStore, physicsEngine.getClock().now());
+        }
+        else {
+            result.ok = false;
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    for (long long step = 0; step < steps && result.ok; step++) {
+        physicsEngine.updatePhysics(bodyStore, celestialBodies, deltaTime);
+
+        recorder.recordStep(bodyStore, physicsEngine.getClock().now());
+
+        if (outputs.checkpointInterval > 0 && (step + 1) % outputs.checkpointInterval == 0 && step + 1 < steps) {
+            checkpointWriter.save(outputs.checkpointPath, bodyStore, celestialBodies, physicsEngine, true);
+        }
+    }
+
+    recorder.close();
+    if (!outputs.checkpointPath.empty() && result.ok) {
+        checkpointWriter.save(outputs.checkpointPath, bodyStore, celestialBodies, physicsEngine, true);
+    }
+    if (!checkpointWriter.wait()) result.ok = false;
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.simulatedTime = physicsEngine.getClock().now();
+    result.forceEvaluations = physicsEngine.getForceEvaluations();
+
+    // Read straight from the store so double state is not rounded to float on the way out
+    for (const auto& body : celestialBodies) {
+        int i = body->index();
+        result.names.push_back(body->name);
+        result.positions.push_back(glm::dvec3(bodyStore.x[i], bodyStore.y[i], bodyStore.z[i]));
+    }
+
+    for (auto body : celestialBodies) {
+        delete body;
+    }
+
+    return result;
+}
+
+bool savePositions(const string& path, const RunResult& result) {
+    ofstream file(path);
+    if (!file) return false;
+
+    file << setprecision(17);
+    for (size_t i = 0; i < result.positions.size(); i++) {
+        file << result.names[i] << " " << result.positions[i].x << " " << result.positions[i].y << " " << result.positions[i].z << endl;
+    }
+    return true;
+}
+
+bool loadPositions(const string& path, vector<glm::dvec3>& positions) {
+    ifstream file(path);
+    if (!file) return false;
+
+    string name;
+    glm::dvec3 position;
+    while (file >> name >> position.x >> position.y >> position.z) {
+        positions.push_back(position);
+    }
+    return true;
+}
+
+// Distance of every body from where the reference has it, as "max / median".
+// The median is reported too because one close encounter can dominate the max
+string positionError(const RunResult& result, const vector<glm::dvec3>& reference) {
+    if (reference.size() != result.positions.size() || reference.empty()) return "body count differs";
+
+    vector<double> errors;
+    for (size_t i = 0; i < reference.size(); i++) {
+        errors.push_back(glm::length(result.positions[i] - reference[i]));
+    }
+    sort(errors.begin(), errors.end());
+
+    return to_string(errors.back()) + " / " + to_string(errors[errors.size() / 2]);
+}
+
+// Where a recorded run has the bodies at the end time of this run, so runs with different steps can be compared
+bool loadTrajectoryPositions(const string& path, const RunResult& result, vector<glm::dvec3>& positions) {
+    TrajectoryReader reader;
+    if (!reader.open(path)) return false;
+
+    if (result.simulatedTime > reader.getEndTime()) {
+        cout << "The recording ends at " << reader.getEndTime() << "s, comparing against its last frame" << endl;
+    }
+
+    for (const string& name : result.names) {
+        int body = reader.findBody(name);
+        if (body < 0) {
+            positions.clear();
+            return true;
+        }
+        positions.push_back(reader.sample(body, result.simulatedTime).position);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    long long steps = atoll(argv[1]);
+    float deltaTime = 0.016f;
+    string savePath;
+    string comparePath;
+    string compareTrajectoryPath;
+    string tracePath;
+    int sweepCount = 0;
+    RunOutputs outputs;
+
+    PhysicsEngine defaults;
+    PhysicsSettings settings = defaults.getSettings();
+
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (option == "--dt" && hasValue) {
+            deltaTime = static_cast<float>(atof(argv[++i]));
+        }
+        else if (option == "--threads" && hasValue) {
+            settings.threadCount = atoi(argv[++i]);
+        }
+        else if (option == "--integrator" && hasValue) {
+            settings.integrator = static_cast<Integrator>(atoi(argv[++i]) % INTEGRATOR_COUNT);
+        }
+        else if (option == "--barnes-hut") {
+            settings.gravityMode = GRAVITY_BARNES_HUT;
+        }
+        else if (option == "--block") {
+            settings.blockTimesteps = true;
+        }
+        else if (option == "--save" && hasValue) {
+            savePath = argv[++i];
+        }
+        else if (option == "--compare" && hasValue) {
+            comparePath = argv[++i];
+        }
+        else if (option == "--sweep" && hasValue) {
+            sweepCount = atoi(argv[++i]);
+        }
+        else if (option == "--checkpoint" && hasValue) {
+            outputs.checkpointPath = argv[++i];
+        }
+        else if (option == "--checkpoint-every" && hasValue) {
+            outputs.checkpointInterval = atoll(argv[++i]);
+        }
+        else if (option == "--resume" && hasValue) {
+            outputs.resumePath = argv[++i];
+        }
+        else if (option == "--record" && hasValue) {
+            outputs.recordPath = argv[++i];
+        }
+        else if (option == "--record-every" && hasValue) {
+            outputs.recordInterval = atoi(argv[++i]);
+        }
+        else if (option == "--compare-trajectory" && hasValue) {
+            compareTrajectoryPath = argv[++i];
+        }
+        else if (option == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        }
+        else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (steps <= 0 || deltaTime <= 0.0f || sweepCount < 0 || outputs.recordInterval <= 0 ||
+        (outputs.checkpointInterval > 0 && outputs.checkpointPath.empty())) {
+        printUsage();
+        return 1;
+    }
+
+    vector<glm::dvec3> reference;
+    if (!comparePath.empty() && !loadPositions(comparePath, reference)) {
+        cout << "Could not read " << comparePath << endl;
+        return 1;
+    }
+
+    cout << "Stepping the solar system for " << steps << " steps of " << deltaTime << "s ("
+         << getIntegratorName(settings.integrator) << ", " << settings.threadCount << " threads, "
+         << getPrecisionName() << " precision)" << endl;
+
+    if (!tracePath.empty()) {
+        Profiler::setThreadName("Main");
+        Profiler::setEnabled(true);
+    }
+
+    // Runs from the finest step up, so without a saved reference the finest run is the reference
+    vector<RunResult> results(sweepCount + 1);
+    // Only the main run resumes, checkpoints and records
+    for (int run = sweepCount; run >= 0; run--) {
+        results[run] = runScene(settings, deltaTime / (1 << run), steps << run, run == 0 ? outputs : RunOutputs());
+    }
+
+    const RunResult& result = results[0];
+    if (!result.ok) return 1;
+
+    cout << "Simulated " << result.simulatedTime << "s in " << result.seconds << "s ("
+         << steps / result.seconds << " steps/s, " << result.forceEvaluations << " force evaluations)" << endl;
+
+    for (size_t i = 0; i < result.positions.size(); i++) {
+        cout << result.names[i] << ": " << result.positions[i].x << " " << result.positions[i].y << " " << result.positions[i].z << endl;
+    }
+
+    if (sweepCount > 0) {
+        const vector<glm::dvec3>& sweepReference = reference.empty() ? results[sweepCount].positions : reference;
+
+        cout << endl << "dt, steps, seconds, us/step, max / median position error ("
+             << (reference.empty() ? "against the finest run" : "against " + comparePath) << ")" << endl;
+
+        for (int run = 0; run <= sweepCount; run++) {
+            long long runSteps = steps << run;
+            cout << deltaTime / (1 << run) << ", " << runSteps << ", " << results[run].seconds << ", "
+                 << results[run].seconds * 1e6 / runSteps << ", " << positionError(results[run], sweepReference) << endl;
+        }
+    }
+    else if (!reference.empty()) {
+        cout << "Max / median position error against " << comparePath << ": " << positionError(result, reference) << endl;
+    }
+
+    if (!compareTrajectoryPath.empty()) {
+        vector<glm::dvec3> recorded;
+        if (!loadTrajectoryPositions(compareTrajectoryPath, result, recorded)) {
+            cout << "Could not read " << compareTrajectoryPath << endl;
+            return 1;
+        }
+        cout << "Max / median position error against " << compareTrajectoryPath << ": " << positionError(result, recorded) << endl;
+    }
+
+    if (!tracePath.empty() && !Profiler::exportChromeTrace(tracePath)) {
+        cout << "Could not write " << tracePath << endl;
+        return 1;
+    }
+
+    if (!savePath.empty() && !savePositions(savePath, result)) {
+        cout << "Could not write " << savePath << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "Integrator.h"
+#include <cmath>
+
+using namespace std;
+
+// Triple jump weights that cancel the 3rd order error of leapfrog
+static const double yoshidaW1 = 1.0 / (2.0 - cbrt(2.0));
+static const double yoshidaW0 = 1.0 - 2.0 * yoshidaW1;
+
+// Omelyan, Mryglod and Folk (2002), optimised to give the smallest 4th order error
+static const double forestRuthXi = 0.1786178958448091;
+static const double forestRuthLambda = -0.2123418310626054;
+static const double forestRuthChi = -0.06626458266981849;
+
+static const SplittingScheme eulerScheme = {
+    1,
+    { 0.0, 1.0 },
+    { 1.0 }
+};
+
+// Drift-kick-drift, so each step needs only the accelerations at the half step
+static const SplittingScheme leapfrogScheme = {
+    1,
+    { 0.5, 0.5 },
+    { 1.0 }
+};
+
+static const SplittingScheme yoshidaScheme = {
+    3,
+    { yoshidaW1 / 2.0, (yoshidaW0 + yoshidaW1) / 2.0, (yoshidaW0 + yoshidaW1) / 2.0, yoshidaW1 / 2.0 },
+    { yoshidaW1, yoshidaW0, yoshidaW1 }
+};
+
+static const SplittingScheme forestRuthScheme = {
+    4,
+    { forestRuthXi, forestRuthChi, 1.0 - 2.0 * (forestRuthChi + forestRuthXi), forestRuthChi, forestRuthXi },
+    { (1.0 - 2.0 * forestRuthLambda) / 2.0, forestRuthLambda, forestRuthLambda, (1.0 - 2.0 * forestRuthLambda) / 2.0 }
+};
+
+const SplittingScheme& getSplittingScheme(Integrator integrator) {
+    switch (integrator) {
+    case INTEGRATOR_LEAPFROG: return leapfrogScheme;
+    case INTEGRATOR_YOSHIDA4: return yoshidaScheme;
+    case INTEGRATOR_FOREST_RUTH: return forestRuthScheme;
+    default: return eulerScheme;
+    }
+}
+
+const char* getIntegratorName(Integrator integrator) {
+    switch (integrator) {
+    case INTEGRATOR_LEAPFROG: return "Leapfrog";
+    case INTEGRATOR_YOSHIDA4: return "Yoshida 4th order";
+    case INTEGRATOR_FOREST_RUTH: return "Forest-Ruth (PEFRL)";
+    default: return "Semi-implicit Euler";
+    }
+}
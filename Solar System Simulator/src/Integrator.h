@@ -0,0 +1,25 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+enum Integrator {
+    INTEGRATOR_EULER = 0,       // Semi-implicit Euler, 1st order, 1 force evaluation per step
+    INTEGRATOR_LEAPFROG = 1,    // Leapfrog, 2nd order, 1 force evaluation per step
+    INTEGRATOR_YOSHIDA4 = 2,    // Yoshida triple jump, 4th order, 3 force evaluations per step
+    INTEGRATOR_FOREST_RUTH = 3  // Position-extended Forest-Ruth (Omelyan), 4th order, 4 force evaluations per step
+};
+
+const int INTEGRATOR_COUNT = 4;
+const int MAX_SPLITTING_STAGES = 4;
+
+// A step alternates drifts (position += drift * dt * velocity) and kicks (velocity += kick * dt * acceleration):
+// drift[0], kick[0], drift[1], kick[1], ... drift[stages]. Accelerations are recomputed before every kick
+struct SplittingScheme {
+    int stages;
+    double drift[MAX_SPLITTING_STAGES + 1];
+    double kick[MAX_SPLITTING_STAGES];
+};
+
+const SplittingScheme& getSplittingScheme(Integrator integrator);
+const char* getIntegratorName(Integrator integrator);
+
+#endif
\ No newline at end of file
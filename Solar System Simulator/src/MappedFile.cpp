@@ -0,0 +1,205 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : mapping(nullptr), mappedSize(0), writable(false), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {}
+
+bool MappedFile::create(const string& path, size_t size) {
+    close();
+
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+    writable = true;
+    mappedSize = size;
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::openRead(const string& path) {
+    close();
+
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    writable = false;
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping && writable) flush();
+    unmap();
+
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+    mappedSize = 0;
+}
+
+bool MappedFile::map() {
+    if (writable) {
+        // Sets the file length as well
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(mappedSize);
+        if (!SetFilePointerEx(fileHandle, size, nullptr, FILE_BEGIN) || !SetEndOfFile(fileHandle)) return false;
+    }
+
+    DWORD protection = writable ? PAGE_READWRITE : PAGE_READONLY;
+    DWORD access = writable ? FILE_MAP_WRITE : FILE_MAP_READ;
+    DWORD sizeHigh = static_cast<DWORD>(static_cast<unsigned long long>(mappedSize) >> 32);
+    DWORD sizeLow = static_cast<DWORD>(mappedSize & 0xFFFFFFFFull);
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, protection, sizeHigh, sizeLow, nullptr);
+    if (!mappingHandle) return false;
+
+    mapping = static_cast<char*>(MapViewOfFile(mappingHandle, access, 0, 0, mappedSize));
+    return mapping != nullptr;
+}
+
+void MappedFile::unmap() {
+    if (mapping) {
+        UnmapViewOfFile(mapping);
+        mapping = nullptr;
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+}
+
+bool MappedFile::flush() {
+    return mapping && FlushViewOfFile(mapping, 0) != 0;
+}
+
+#else
+
+MappedFile::MappedFile() : mapping(nullptr), mappedSize(0), writable(false), fileDescriptor(-1) {}
+
+bool MappedFile::create(const string& path, size_t size) {
+    close();
+
+    fileDescriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0) return false;
+
+    writable = true;
+    mappedSize = size;
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::openRead(const string& path) {
+    close();
+
+    fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) return false;
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0) {
+        close();
+        return false;
+    }
+
+    writable = false;
+    mappedSize = static_cast<size_t>(fileStatus.st_size);
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapping && writable) flush();
+    unmap();
+
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+    mappedSize = 0;
+}
+
+bool MappedFile::map() {
+    // Sets the file length as well
+    if (writable && ftruncate(fileDescriptor, static_cast<off_t>(mappedSize)) != 0) return false;
+
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* address = mmap(nullptr, mappedSize, protection, MAP_SHARED, fileDescriptor, 0);
+    if (address == MAP_FAILED) return false;
+
+    mapping = static_cast<char*>(address);
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (mapping) {
+        munmap(mapping, mappedSize);
+        mapping = nullptr;
+    }
+}
+
+bool MappedFile::flush() {
+    return mapping && msync(mapping, mappedSize, MS_SYNC) == 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::resize(size_t newSize) {
+    if (!mapping || !writable) return false;
+
+    flush();
+    unmap();
+    mappedSize = newSize;
+    return map();
+}
+
+bool MappedFile::isOpen() const {
+    return mapping != nullptr;
+}
+
+char* MappedFile::data() {
+    return mapping;
+}
+
+const char* MappedFile::data() const {
+    return mapping;
+}
+
+size_t MappedFile::size() const {
+    return mappedSize;
+}
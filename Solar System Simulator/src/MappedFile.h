@@ -0,0 +1,50 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// A file mapped into memory. Writable files can grow, which maps them again at a new address
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // New file of 'size' bytes, replacing any existing one
+    bool create(const string& path, size_t size);
+    // Existing file, read only
+    bool openRead(const string& path);
+    void close();
+
+    // Writable files only, keeps the contents
+    bool resize(size_t newSize);
+    // Pushes written pages to the file
+    bool flush();
+
+    bool isOpen() const;
+    char* data();
+    const char* data() const;
+    size_t size() const;
+
+private:
+    char* mapping;
+    size_t mappedSize;
+    bool writable;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    bool map();
+    void unmap();
+};
+
+#endif
\ No newline at end of file
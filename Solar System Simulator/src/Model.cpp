@@ -128,4 +128,13 @@ void Model::create() {
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
+}
+
+// Draws the mesh once per instance, instance attributes are set up by the caller on this VAO
+void Model::createInstanced(GLsizei instanceCount) {
+    if (instanceCount <= 0) return;
+
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0, instanceCount);
+    glBindVertexArray(0);
 }
\ No newline at end of file
@@ -18,9 +18,12 @@ public:
     Model();
     ~Model();
     void create();
+    void createInstanced(GLsizei instanceCount);
     void createSphere(float radius, int sectors, int stacks);
     void createRing(float innerRadius, float outerRadius, int sectors);
 
+    GLuint getVAO() const { return VAO; }
+
 private:
     GLuint VAO, VBO, EBO;
     vector<Vertex> vertices;
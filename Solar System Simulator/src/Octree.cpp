@@ -0,0 +1,286 @@
+#include "Octree.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const int MAX_TREE_DEPTH = 32; // Bodies closer than this can resolve stay together in one leaf
+const int LEAF_CAPACITY = 16; // Bodies a leaf holds before it is split
+const int GROUP_CAPACITY = 128; // Bodies sharing one interaction list, more amortize the walk but lengthen the list
+
+Octree::Octree() : bodies(nullptr) {}
+
+void Octree::build(const BodyStore& store) {
+    bodies = &store;
+
+    int count = store.size();
+
+    nodes.clear();
+    groups.clear();
+    bodyIndices.resize(count);
+    scratchIndices.resize(count);
+
+    if (count == 0) return;
+
+    // Bounding cube of all bodies
+    glm::vec3 minBound = store.getForcePosition(0);
+    glm::vec3 maxBound = minBound;
+
+    for (int i = 0; i < count; i++) {
+        bodyIndices[i] = i;
+        minBound = glm::min(minBound, store.getForcePosition(i));
+        maxBound = glm::max(maxBound, store.getForcePosition(i));
+    }
+
+    glm::vec3 extent = maxBound - minBound;
+    float halfSize = max(max(extent.x, extent.y), extent.z) * 0.5f + 0.01f;
+
+    OctreeNode root;
+    root.center = (minBound + maxBound) * 0.5f;
+    root.halfSize = halfSize;
+    nodes.push_back(root);
+
+    buildNode(0, 0, count, 0, false);
+
+    // Copies of the bodies in tree order, so every leaf is a contiguous run of the arrays
+    const float* x = store.forceX();
+    const float* y = store.forceY();
+    const float* z = store.forceZ();
+
+    sortedX.resize(count);
+    sortedY.resize(count);
+    sortedZ.resize(count);
+    sortedMass.resize(count);
+    bodySlots.resize(count);
+
+    for (int i = 0; i < count; i++) {
+        int body = bodyIndices[i];
+        sortedX[i] = x[body];
+        sortedY[i] = y[body];
+        sortedZ[i] = z[body];
+        sortedMass[i] = store.mass[body];
+        bodySlots[body] = i;
+    }
+}
+
+void Octree::buildNode(int nodeIndex, int begin, int end, int depth, bool inGroup) {
+    const float* x = bodies->forceX();
+    const float* y = bodies->forceY();
+    const float* z = bodies->forceZ();
+    const vector<float>& mass = bodies->mass;
+
+    nodes[nodeIndex].firstChild = -1;
+    nodes[nodeIndex].firstBody = begin;
+    nodes[nodeIndex].bodyCount = end - begin;
+
+    // Total mass and center of mass of the cube
+    float totalMass = 0.0f;
+    glm::vec3 weightedPosition(0.0f);
+
+    for (int i = begin; i < end; i++) {
+        int body = bodyIndices[i];
+        totalMass += mass[body];
+        weightedPosition += glm::vec3(x[body], y[body], z[body]) * mass[body];
+    }
+
+    nodes[nodeIndex].mass = totalMass;
+    nodes[nodeIndex].centerOfMass = totalMass > 0.0f ? weightedPosition / totalMass : nodes[nodeIndex].center;
+
+    // The largest cubes with few enough bodies each walk the tree once for all of them
+    if (!inGroup && end - begin <= GROUP_CAPACITY) {
+        groups.push_back(nodeIndex);
+        inGroup = true;
+    }
+
+    if (end - begin <= LEAF_CAPACITY || depth >= MAX_TREE_DEPTH) return;
+
+    glm::vec3 center = nodes[nodeIndex].center;
+    float childHalf = nodes[nodeIndex].halfSize * 0.5f;
+
+    // Sort bodies of this cube by octant (bit 0 = x, bit 1 = y, bit 2 = z)
+    int octantStart[9] = { 0 };
+
+    for (int i = begin; i < end; i++) {
+        int body = bodyIndices[i];
+        int octant = (x[body] >= center.x ? 1 : 0) | (y[body] >= center.y ? 2 : 0) | (z[body] >= center.z ? 4 : 0);
+        octantStart[octant + 1]++;
+    }
+
+    for (int o = 0; o < 8; o++) {
+        octantStart[o + 1] += octantStart[o];
+    }
+
+    int octantFill[8];
+    for (int o = 0; o < 8; o++) {
+        octantFill[o] = begin + octantStart[o];
+    }
+
+    for (int i = begin; i < end; i++) {
+        int body = bodyIndices[i];
+        int octant = (x[body] >= center.x ? 1 : 0) | (y[body] >= center.y ? 2 : 0) | (z[body] >= center.z ? 4 : 0);
+        scratchIndices[octantFill[octant]++] = bodyIndices[i];
+    }
+
+    copy(scratchIndices.begin() + begin, scratchIndices.begin() + end, bodyIndices.begin() + begin);
+
+    // Children are appended together so they can be visited as a block
+    int firstChild = static_cast<int>(nodes.size());
+    nodes[nodeIndex].firstChild = firstChild;
+
+    for (int o = 0; o < 8; o++) {
+        OctreeNode child;
+        child.center = center + glm::vec3((o & 1) ? childHalf : -childHalf,
+                                          (o & 2) ? childHalf : -childHalf,
+                                          (o & 4) ? childHalf : -childHalf);
+        child.halfSize = childHalf;
+        child.mass = 0.0f;
+        child.centerOfMass = child.center;
+        child.firstChild = -1;
+        child.firstBody = begin + octantStart[o];
+        child.bodyCount = 0;
+        nodes.push_back(child);
+    }
+
+    for (int o = 0; o < 8; o++) {
+        int childBegin = begin + octantStart[o];
+        int childEnd = begin + octantStart[o + 1];
+
+        if (childEnd > childBegin) {
+            buildNode(firstChild + o, childBegin, childEnd, depth + 1, inGroup);
+        }
+    }
+}
+
+// The group's bodies first, then every body of the leaves near it and the cubes far enough away to count as one mass.
+// Returns the Sun's position in the list, -1 if it isn't in it as a body
+int Octree::buildInteractionList(int groupIndex, float theta, int sunSlot, OctreeWalkBuffers& buffers) const {
+    buffers.x.clear();
+    buffers.y.clear();
+    buffers.z.clear();
+    buffers.mass.clear();
+    int listSun = -1;
+
+    auto appendBodies = [&](const OctreeNode& node) {
+        int first = node.firstBody;
+        int last = node.firstBody + node.bodyCount;
+        if (sunSlot >= first && sunSlot < last) listSun = static_cast<int>(buffers.x.size()) + sunSlot - first;
+
+        buffers.x.insert(buffers.x.end(), sortedX.begin() + first, sortedX.begin() + last);
+        buffers.y.insert(buffers.y.end(), sortedY.begin() + first, sortedY.begin() + last);
+        buffers.z.insert(buffers.z.end(), sortedZ.begin() + first, sortedZ.begin() + last);
+        buffers.mass.insert(buffers.mass.end(), sortedMass.begin() + first, sortedMass.begin() + last);
+    };
+
+    const OctreeNode& group = nodes[groupIndex];
+    appendBodies(group);
+
+    // Box around the group's bodies, a cube only counts as one mass if it is far from all of them
+    glm::vec3 boxMin(sortedX[group.firstBody], sortedY[group.firstBody], sortedZ[group.firstBody]);
+    glm::vec3 boxMax = boxMin;
+    for (int i = group.firstBody + 1; i < group.firstBody + group.bodyCount; i++) {
+        glm::vec3 position(sortedX[i], sortedY[i], sortedZ[i]);
+        boxMin = glm::min(boxMin, position);
+        boxMax = glm::max(boxMax, position);
+    }
+    glm::vec3 boxCenter = (boxMin + boxMax) * 0.5f;
+    glm::vec3 boxHalf = (boxMax - boxMin) * 0.5f;
+
+    const float closeSq = CLOSE_ENCOUNTER_DISTANCE * CLOSE_ENCOUNTER_DISTANCE;
+    const float thetaSq = theta * theta;
+
+    int stack[8 * MAX_TREE_DEPTH + 8];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        int index = stack[--stackSize];
+        if (index == groupIndex) continue;
+
+        const OctreeNode& node = nodes[index];
+
+        // Nearest distance from the box to the center of mass. A cube overlapping the box may hold one of
+        // its bodies and is always opened, so is one within close encounter distance
+        glm::vec3 gap = glm::max(glm::abs(node.centerOfMass - boxCenter) - boxHalf, glm::vec3(0.0f));
+        float distSq = glm::dot(gap, gap);
+        glm::vec3 separation = glm::abs(node.center - boxCenter) - boxHalf;
+        bool overlaps = separation.x <= node.halfSize && separation.y <= node.halfSize && separation.z <= node.halfSize;
+        float size = node.halfSize * 2.0f;
+
+        if (!overlaps && distSq >= closeSq && size * size < thetaSq * distSq) {
+            buffers.x.push_back(node.centerOfMass.x);
+            buffers.y.push_back(node.centerOfMass.y);
+            buffers.z.push_back(node.centerOfMass.z);
+            buffers.mass.push_back(node.mass);
+            continue;
+        }
+
+        if (node.firstChild < 0) {
+            appendBodies(node);
+            continue;
+        }
+
+        // Empty octants never pull, they are not visited
+        for (int o = 0; o < 8; o++) {
+            int child = node.firstChild + o;
+            if (nodes[child].bodyCount > 0) stack[stackSize++] = child;
+        }
+    }
+
+    return listSun;
+}
+
+long long Octree::accumulateGroups(int begin, int end, const BarnesHutParameters& parameters, OctreeWalkBuffers& buffers,
+                                   float* ax, float* ay, float* az) const {
+    long long interactions = 0;
+    int sunSlot = parameters.sun >= 0 ? bodySlots[parameters.sun] : -1;
+
+    for (int g = begin; g < end; g++) {
+        const OctreeNode& group = nodes[groups[g]];
+
+        buffers.targets.clear();
+        for (int i = 0; i < group.bodyCount; i++) {
+            int body = bodyIndices[group.firstBody + i];
+            if (!parameters.isTarget || parameters.isTarget[body]) buffers.targets.push_back(i);
+        }
+        if (buffers.targets.empty()) continue;
+
+        int listSun = buildInteractionList(groups[g], parameters.theta, sunSlot, buffers);
+
+        GravitySources sources;
+        sources.x = buffers.x.data();
+        sources.y = buffers.y.data();
+        sources.z = buffers.z.data();
+        sources.mass = buffers.mass.data();
+        sources.count = static_cast<int>(buffers.x.size());
+        sources.sun = listSun;
+        sources.G = parameters.G;
+        sources.minDistanceSq = parameters.minDistance * parameters.minDistance;
+
+        buffers.ax.assign(group.bodyCount, 0.0f);
+        buffers.ay.assign(group.bodyCount, 0.0f);
+        buffers.az.assign(group.bodyCount, 0.0f);
+
+        int targetCount = static_cast<int>(buffers.targets.size());
+        runGatherKernel(parameters.kernel, sources, buffers.targets.data(), targetCount,
+                        buffers.ax.data(), buffers.ay.data(), buffers.az.data());
+
+        for (int t : buffers.targets) {
+            int body = bodyIndices[group.firstBody + t];
+            ax[body] += buffers.ax[t];
+            ay[body] += buffers.ay[t];
+            az[body] += buffers.az[t];
+        }
+
+        interactions += static_cast<long long>(targetCount) * (sources.count - 1);
+    }
+
+    return interactions;
+}
+
+int Octree::getNodeCount() const {
+    return static_cast<int>(nodes.size());
+}
+
+int Octree::getGroupCount() const {
+    return static_cast<int>(groups.size());
+}
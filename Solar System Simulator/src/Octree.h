@@ -0,0 +1,69 @@
+#ifndef OCTREE_H
+#define OCTREE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "BodyStore.h"
+#include "GravityKernels.h"
+
+using namespace std;
+
+// One cube of the Barnes-Hut tree. Children are stored as 8 consecutive nodes
+struct OctreeNode {
+    glm::vec3 center;       // Geometric center of the cube
+    float halfSize;         // Half of the cube edge length
+    glm::vec3 centerOfMass;
+    float mass;
+    int firstChild;         // Index of the first child node, -1 for leaves
+    int firstBody;          // Start of the cube's bodies in bodyIndices, they are contiguous
+    int bodyCount;          // Number of bodies inside the cube
+};
+
+// How a walk sums the pull on the bodies
+struct BarnesHutParameters {
+    GravityKernel kernel;
+    float theta;       // Opening angle, 0 sums every body exactly
+    float G;
+    float minDistance;
+    int sun;           // Store index of the Sun, -1 if there is none
+    const unsigned char* isTarget; // Bodies that need forces by store index, nullptr for all of them
+};
+
+// Buffers one thread reuses from group to group
+struct OctreeWalkBuffers {
+    vector<float> x, y, z, mass; // Interaction list: the group's own bodies, then nearby bodies, then distant cubes
+    vector<int> targets;         // List positions of the group bodies that need forces
+    vector<float> ax, ay, az;
+};
+
+class Octree {
+public:
+    Octree();
+
+    // Rebuilds the tree; node storage is reused between calls
+    void build(const BodyStore& store);
+
+    // Adds the pull of every other body to the targets in groups [begin, end). A group is a cube of up to 128
+    // bodies that share one interaction list, summed with the gather kernel. Body pairs get the direct sum's close
+    // encounter boost, cubes are only treated as one mass beyond that distance. Returns the interactions summed
+    long long accumulateGroups(int begin, int end, const BarnesHutParameters& parameters, OctreeWalkBuffers& buffers,
+                               float* ax, float* ay, float* az) const;
+
+    int getNodeCount() const;
+    int getGroupCount() const;
+
+private:
+    vector<OctreeNode> nodes;
+    vector<int> groups; // Node index of every group, together they hold each body once
+    vector<int> bodyIndices;
+    vector<int> scratchIndices;
+    vector<float> sortedX, sortedY, sortedZ, sortedMass; // Positions and masses in bodyIndices order
+    vector<int> bodySlots; // Store index -> position in the sorted arrays
+
+    const BodyStore* bodies;
+
+    void buildNode(int nodeIndex, int begin, int end, int depth, bool inGroup);
+    int buildInteractionList(int groupIndex, float theta, int sunSlot, OctreeWalkBuffers& buffers) const;
+};
+
+#endif
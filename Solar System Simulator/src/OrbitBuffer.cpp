@@ -0,0 +1,120 @@
+#include "OrbitBuffer.h"
+#include <algorithm>
+#include <cstddef>
+
+// Longest wait for the GPU to release a ring region, in nanoseconds
+const GLuint64 ORBIT_FENCE_TIMEOUT = 1000000000;
+
+OrbitBuffer::OrbitBuffer() : VAO(0), VBO(0), regionCapacity(0), region(0), mapped(nullptr),
+    mappedVertices(0), writeOffset(0) {
+    for (int i = 0; i < ORBIT_RING_REGIONS; i++) fences[i] = 0;
+}
+
+void OrbitBuffer::create() {
+    if (VAO) return;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    // Vertex positions
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(OrbitVertex), (void*)offsetof(OrbitVertex, position));
+
+    // Vertex colors
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(OrbitVertex), (void*)offsetof(OrbitVertex, color));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OrbitBuffer::destroy() {
+    clearFences();
+    if (VAO) glDeleteVertexArrays(1, &VAO);
+    if (VBO) glDeleteBuffers(1, &VBO);
+    VAO = 0;
+    VBO = 0;
+    regionCapacity = 0;
+    region = 0;
+}
+
+void OrbitBuffer::clearFences() {
+    for (int i = 0; i < ORBIT_RING_REGIONS; i++) {
+        if (fences[i]) glDeleteSync(fences[i]);
+        fences[i] = 0;
+    }
+}
+
+// Grows every ring region to hold at least the given vertices, only when the orbits outgrow it
+void OrbitBuffer::reserve(GLsizei vertices) {
+    if (vertices <= regionCapacity) return;
+
+    regionCapacity = max(vertices, regionCapacity * 2);
+
+    // New storage, so nothing is left to wait for
+    clearFences();
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)regionCapacity * ORBIT_RING_REGIONS * sizeof(OrbitVertex), NULL, GL_STREAM_DRAW);
+}
+
+bool OrbitBuffer::begin(GLsizei totalVertices) {
+    firsts.clear();
+    counts.clear();
+    writeOffset = 0;
+    mapped = nullptr;
+    mappedVertices = 0;
+
+    if (!VAO || totalVertices <= 0) return false;
+
+    reserve(totalVertices);
+    region = (region + 1) % ORBIT_RING_REGIONS;
+
+    // Wait until the GPU has drawn what was last written here
+    if (fences[region]) {
+        glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, ORBIT_FENCE_TIMEOUT);
+        glDeleteSync(fences[region]);
+        fences[region] = 0;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLintptr offset = (GLintptr)region * regionCapacity * sizeof(OrbitVertex);
+    mapped = (OrbitVertex*)glMapBufferRange(GL_ARRAY_BUFFER, offset, (GLsizeiptr)totalVertices * sizeof(OrbitVertex),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!mapped) return false;
+
+    mappedVertices = totalVertices;
+    return true;
+}
+
+OrbitVertex* OrbitBuffer::addStrip(GLsizei vertexCount) {
+    if (!mapped || writeOffset + vertexCount > mappedVertices) return nullptr;
+
+    OrbitVertex* strip = mapped + writeOffset;
+    firsts.push_back(region * regionCapacity + writeOffset);
+    counts.push_back(vertexCount);
+    writeOffset += vertexCount;
+    return strip;
+}
+
+void OrbitBuffer::end() {
+    if (!mapped) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    bool intact = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    mapped = nullptr;
+
+    // The driver can lose mapped contents, skip the frame then
+    if (!intact || firsts.empty()) return;
+
+    glBindVertexArray(VAO);
+    glMultiDrawArrays(GL_LINE_STRIP, firsts.data(), counts.data(), (GLsizei)firsts.size());
+    glBindVertexArray(0);
+
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,51 @@
+#ifndef ORBIT_BUFFER_H
+#define ORBIT_BUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+using namespace std;
+
+// Frames of orbit vertices the ring holds, the GPU can still be reading the older ones
+const int ORBIT_RING_REGIONS = 3;
+
+struct OrbitVertex {
+    glm::vec3 position;
+    glm::vec3 color;
+};
+
+// Persistent orbit line buffer, written through a mapped ring and drawn with one glMultiDrawArrays
+class OrbitBuffer {
+public:
+    OrbitBuffer();
+
+    void create();
+    // Deletes the buffer, its fences and the VAO, while the GL context still exists
+    void destroy();
+
+    // Maps room for this frame's vertices, false if nothing can be written
+    bool begin(GLsizei totalVertices);
+    // Reserves the next line strip, the caller fills the returned vertices
+    OrbitVertex* addStrip(GLsizei vertexCount);
+    // Unmaps and draws every strip added since begin()
+    void end();
+
+private:
+    GLuint VAO, VBO;
+    GLsizei regionCapacity; // Vertices per ring region
+    int region; // Region written this frame
+    GLsync fences[ORBIT_RING_REGIONS]; // Signalled when the GPU is done with a region
+    OrbitVertex* mapped;
+    GLsizei mappedVertices;
+    GLsizei writeOffset;
+
+    // Strip ranges of this frame, reused between frames
+    vector<GLint> firsts;
+    vector<GLsizei> counts;
+
+    void reserve(GLsizei vertices);
+    void clearFences();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,404 @@
+// Times the physics on generated scenes from 10 to a million bodies, in the manner of Google Benchmark:
+// every case repeats until it has run for a minimum time, results go to the console and optionally to JSON
+#include "PhysicsEngine.h"
+#include "SolarSystemScene.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+
+using namespace std;
+
+// One measured case
+struct BenchmarkResult {
+    string name;
+    string scene;
+    string gravity;
+    int bodies;
+    int threads;
+    long long iterations;
+    double stepNs;            // Whole updatePhysics call
+    double cpuNs;             // Process CPU time per step, all threads together
+    double collisionNs;       // handleCollisions on its own
+    double integrationNs;     // The rest of the step: forces, kicks and drifts
+    double nsPerInteraction;  // Per body pair for direct gravity, per body-body or body-cube pair for Barnes-Hut
+    double evaluationsPerStep; // Bodies whose forces were calculated, below the body count only with block timesteps
+    double stepsPerSecond;
+    double speedup;           // Against one thread on the same case, 0 if that wasn't run
+};
+
+// What to run, from the command line
+struct BenchmarkOptions {
+    vector<string> scenes;
+    int minBodies;
+    int maxBodies;
+    int directLimit;          // Direct gravity is only timed up to this many bodies
+    vector<int> threadCounts;
+    double minTime;           // Seconds each case runs at least
+    float deltaTime;
+    Integrator integrator;
+    bool blockTimesteps;
+    string filter;            // Only cases whose name contains this
+    string jsonPath;
+
+    BenchmarkOptions() : minBodies(10), maxBodies(1000000), directLimit(20000), minTime(0.5), deltaTime(0.02f),
+                         integrator(INTEGRATOR_LEAPFROG), blockTimesteps(false) {}
+};
+
+static double seconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double cpuSeconds() {
+    return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+void printUsage() {
+    cout << "Usage: PhysicsBenchmark [options]" << endl;
+    cout << "  --scenes <list>       Comma separated: solar, disk, belt, cluster (default all)" << endl;
+    cout << "  --min-bodies <count>  Smallest generated scene (default 10)" << endl;
+    cout << "  --max-bodies <count>  Largest generated scene, sizes go up tenfold (default 1000000)" << endl;
+    cout << "  --direct-limit <count>  Largest scene direct gravity is timed on (default 20000)" << endl;
+    cout << "  --threads <list>      Comma separated thread counts (default powers of two up to the hardware threads)" << endl;
+    cout << "  --min-time <seconds>  Time each case runs at least (default 0.5)" << endl;
+    cout << "  --dt <seconds>        Simulated time per step (default 0.02)" << endl;
+    cout << "  --integrator <0-3>    Euler, Leapfrog, Yoshida, Forest-Ruth (default Leapfrog)" << endl;
+    cout << "  --block               Use individual block timesteps" << endl;
+    cout << "  --filter <text>       Only run cases whose name contains the text" << endl;
+    cout << "  --json <file>         Also write the results as JSON" << endl;
+}
+
+vector<string> splitList(const string& list) {
+    vector<string> items;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Steps a scene until the minimum time is up, timing collisions separately from the whole step
+BenchmarkResult runCase(BodyStore& store, vector<CelestialBody*>& bodies, const BodyStore& initialState, const string& scene,
+                        GravityMode gravityMode, int threads, const BenchmarkOptions& options) {
+    store = initialState;
+
+    PhysicsEngine engine;
+    PhysicsSettings settings = engine.getSettings();
+    settings.gravityMode = gravityMode;
+    settings.integrator = options.integrator;
+    settings.blockTimesteps = options.blockTimesteps;
+    settings.threadCount = threads;
+    engine.applySettings(settings);
+    engine.resolveSpecialBodies(store, bodies);
+
+    // Untimed step so worker threads, the octree and block levels are set up
+    engine.updatePhysics(store, bodies, options.deltaTime);
+
+    long long iterations = 0;
+    long long startEvaluations = engine.getForceEvaluations();
+    long long startInteractions = engine.getGravityInteractions();
+    double stepTime = 0.0, collisionTime = 0.0;
+    double cpuStart = cpuSeconds();
+
+    while (stepTime < options.minTime || iterations == 0) {
+        double start = seconds();
+        engine.handleCollisions(store, bodies);
+        double middle = seconds();
+        engine.updatePhysics(store, bodies, options.deltaTime);
+        double end = seconds();
+
+        collisionTime += middle - start;
+        stepTime += end - middle;
+        iterations++;
+    }
+
+    double cpuTime = cpuSeconds() - cpuStart - collisionTime;
+    double evaluations = static_cast<double>(engine.getForceEvaluations() - startEvaluations);
+    double interactions = static_cast<double>(engine.getGravityInteractions() - startInteractions);
+    int count = store.size();
+
+    BenchmarkResult result;
+    result.scene = scene;
+    result.gravity = gravityMode == GRAVITY_DIRECT ? "direct" : "barnes-hut";
+    result.bodies = count;
+    result.threads = threads;
+    result.name = "updatePhysics/" + scene + "/bodies:" + to_string(count) + "/" + result.gravity + "/threads:" + to_string(threads);
+    result.iterations = iterations;
+    result.stepNs = stepTime * 1e9 / iterations;
+    result.cpuNs = cpuTime * 1e9 / iterations;
+    result.collisionNs = collisionTime * 1e9 / iterations;
+    result.integrationNs = max(0.0, result.stepNs - result.collisionNs);
+    result.stepsPerSecond = iterations / stepTime;
+    result.speedup = 0.0;
+    result.evaluationsPerStep = evaluations / iterations;
+    result.nsPerInteraction = interactions > 0.0 ? result.integrationNs * iterations / interactions : 0.0;
+    return result;
+}
+
+// Eclipse check of the default scene, called in batches so the timer doesn't dominate
+BenchmarkResult runEclipseCase(const BenchmarkOptions& options) {
+    BodyStore store;
+    vector<CelestialBody*> bodies;
+    buildSolarSystem(store, bodies);
+
+    // Sun, Earth and Moon of the default scene
+    CelestialBody* sun = bodies[0];
+    CelestialBody* earth = bodies[3];
+    CelestialBody* moon = bodies[9];
+
+    PhysicsEngine engine;
+    long long iterations = 0;
+    double time = 0.0;
+    while (time < options.minTime) {
+        double start = seconds();
+        for (int i = 0; i < 1000; i++) {
+            engine.checkForEclipse(sun, earth, moon);
+        }
+        time += seconds() - start;
+        iterations += 1000;
+    }
+
+    BenchmarkResult result;
+    result.name = "checkForEclipse/solar";
+    result.scene = "solar";
+    result.gravity = "none";
+    result.bodies = static_cast<int>(bodies.size());
+    result.threads = 1;
+    result.iterations = iterations;
+    result.stepNs = time * 1e9 / iterations;
+    result.cpuNs = result.stepNs;
+    result.collisionNs = 0.0;
+    result.integrationNs = 0.0;
+    result.nsPerInteraction = 0.0;
+    result.evaluationsPerStep = 0.0;
+    result.stepsPerSecond = iterations / time;
+    result.speedup = 0.0;
+
+    for (auto body : bodies) {
+        delete body;
+    }
+    return result;
+}
+
+void printHeader() {
+    cout << left << setw(64) << "Benchmark" << right << setw(14) << "Time (ns)" << setw(12) << "Steps/s" << setw(14) << "Collisions"
+         << setw(14) << "Integration" << setw(12) << "ns/inter." << setw(12) << "Evals/step" << setw(10) << "Speedup" << setw(12) << "Iterations" << endl;
+    cout << string(164, '-') << endl;
+}
+
+void printResult(const BenchmarkResult& result) {
+    cout << left << setw(64) << result.name << right << fixed << setprecision(0) << setw(14) << result.stepNs
+         << setprecision(1) << setw(12) << result.stepsPerSecond << setprecision(0) << setw(14) << result.collisionNs
+         << setw(14) << result.integrationNs << setprecision(3) << setw(12) << result.nsPerInteraction << setprecision(0)
+         << setw(12) << result.evaluationsPerStep << setprecision(2)
+         << setw(10) << result.speedup << setw(12) << result.iterations << endl;
+    cout.unsetf(ios::fixed);
+}
+
+// Same layout as Google Benchmark's JSON output, the extra per-phase numbers are user counters
+bool writeJson(const string& path, const vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    ofstream file(path);
+    if (!file) return false;
+
+    time_t now = time(nullptr);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    file << "{" << endl;
+    file << "  \"context\": {" << endl;
+    file << "    \"date\": \"" << date << "\"," << endl;
+    file << "    \"executable\": \"PhysicsBenchmark\"," << endl;
+    file << "    \"num_cpus\": " << ThreadPool::getHardwareThreads() << "," << endl;
+    file << "    \"precision\": \"" << getPrecisionName() << "\"," << endl;
+    file << "    \"integrator\": \"" << getIntegratorName(options.integrator) << "\"," << endl;
+    file << "    \"block_timesteps\": " << (options.blockTimesteps ? "true" : "false") << "," << endl;
+    file << "    \"delta_time\": " << options.deltaTime << "," << endl;
+#ifdef NDEBUG
+    file << "    \"library_build_type\": \"release\"" << endl;
+#else
+    file << "    \"library_build_type\": \"debug\"" << endl;
+#endif
+    file << "  }," << endl;
+    file << "  \"benchmarks\": [" << endl;
+
+    file << setprecision(10);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        file << "    {" << endl;
+        file << "      \"name\": \"" << result.name << "\"," << endl;
+        file << "      \"run_name\": \"" << result.name << "\"," << endl;
+        file << "      \"run_type\": \"iteration\"," << endl;
+        file << "      \"iterations\": " << result.iterations << "," << endl;
+        file << "      \"real_time\": " << result.stepNs << "," << endl;
+        file << "      \"cpu_time\": " << result.cpuNs << "," << endl;
+        file << "      \"time_unit\": \"ns\"," << endl;
+        file << "      \"scene\": \"" << result.scene << "\"," << endl;
+        file << "      \"gravity\": \"" << result.gravity << "\"," << endl;
+        file << "      \"bodies\": " << result.bodies << "," << endl;
+        file << "      \"threads\": " << result.threads << "," << endl;
+        file << "      \"steps_per_second\": " << result.stepsPerSecond << "," << endl;
+        file << "      \"collisions_ns\": " << result.collisionNs << "," << endl;
+        file << "      \"integration_ns\": " << result.integrationNs << "," << endl;
+        file << "      \"ns_per_interaction\": " << result.nsPerInteraction << "," << endl;
+        file << "      \"evaluations_per_step\": " << result.evaluationsPerStep << "," << endl;
+        file << "      \"speedup\": " << result.speedup << endl;
+        file << "    }" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+
+    file << "  ]" << endl;
+    file << "}" << endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    options.scenes = { "solar", "disk", "belt", "cluster" };
+
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (option == "--scenes" && hasValue) {
+            options.scenes = splitList(argv[++i]);
+        }
+        else if (option == "--min-bodies" && hasValue) {
+            options.minBodies = atoi(argv[++i]);
+        }
+        else if (option == "--max-bodies" && hasValue) {
+            options.maxBodies = atoi(argv[++i]);
+        }
+        else if (option == "--direct-limit" && hasValue) {
+            options.directLimit = atoi(argv[++i]);
+        }
+        else if (option == "--threads" && hasValue) {
+            for (const string& count : splitList(argv[++i])) {
+                options.threadCounts.push_back(atoi(count.c_str()));
+            }
+        }
+        else if (option == "--min-time" && hasValue) {
+            options.minTime = atof(argv[++i]);
+        }
+        else if (option == "--dt" && hasValue) {
+            options.deltaTime = static_cast<float>(atof(argv[++i]));
+        }
+        else if (option == "--integrator" && hasValue) {
+            options.integrator = static_cast<Integrator>(atoi(argv[++i]) % INTEGRATOR_COUNT);
+        }
+        else if (option == "--block") {
+            options.blockTimesteps = true;
+        }
+        else if (option == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (option == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        }
+        else {
+            cout << "Unknown option: " << option << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (options.minBodies < 2 || options.maxBodies < options.minBodies || options.minTime <= 0.0 || options.deltaTime <= 0.0f) {
+        printUsage();
+        return 1;
+    }
+
+    // One thread first, it is what the speedups are measured against
+    if (options.threadCounts.empty()) {
+        int hardware = ThreadPool::getHardwareThreads();
+        for (int threads = 1; threads < hardware; threads *= 2) {
+            options.threadCounts.push_back(threads);
+        }
+        options.threadCounts.push_back(hardware);
+    }
+
+    cout << "Running PhysicsBenchmark on " << ThreadPool::getHardwareThreads() << " hardware threads ("
+         << getIntegratorName(options.integrator) << (options.blockTimesteps ? ", block timesteps" : "") << ", "
+         << getPrecisionName() << " precision, dt " << options.deltaTime << ")" << endl;
+    printHeader();
+
+    vector<BenchmarkResult> results;
+    BodyStore store, initialState;
+    vector<CelestialBody*> bodies;
+
+    for (const string& scene : options.scenes) {
+        // The default scene has one size, the generated ones go up tenfold
+        vector<int> sizes;
+        if (scene == "solar") {
+            sizes.push_back(0);
+        }
+        else {
+            for (long long count = options.minBodies; count <= options.maxBodies; count *= 10) {
+                sizes.push_back(static_cast<int>(count));
+            }
+        }
+
+        ProceduralScene procedural = SCENE_COUNT;
+        for (int type = 0; type < SCENE_COUNT; type++) {
+            if (scene == getSceneName(static_cast<ProceduralScene>(type))) procedural = static_cast<ProceduralScene>(type);
+        }
+        if (scene != "solar" && procedural == SCENE_COUNT) {
+            cout << "Unknown scene: " << scene << endl;
+            continue;
+        }
+
+        for (int size : sizes) {
+            bool sceneBuilt = false;
+
+            for (int mode = GRAVITY_DIRECT; mode <= GRAVITY_BARNES_HUT; mode++) {
+                GravityMode gravityMode = static_cast<GravityMode>(mode);
+                if (gravityMode == GRAVITY_DIRECT && size > options.directLimit) continue;
+
+                double singleThreadNs = 0.0;
+                for (int threads : options.threadCounts) {
+                    string gravity = gravityMode == GRAVITY_DIRECT ? "direct" : "barnes-hut";
+                    string name = "updatePhysics/" + scene + "/bodies:" + to_string(scene == "solar" ? 10 : size) + "/" + gravity +
+                                  "/threads:" + to_string(threads);
+                    if (!options.filter.empty() && name.find(options.filter) == string::npos) continue;
+
+                    // Built only once a case of this size is wanted, a million bodies take a while
+                    if (!sceneBuilt) {
+                        if (scene == "solar") buildSolarSystem(store, bodies);
+                        else buildProceduralScene(store, bodies, procedural, size);
+                        initialState = store;
+                        sceneBuilt = true;
+                    }
+
+                    BenchmarkResult result = runCase(store, bodies, initialState, scene, gravityMode, threads, options);
+                    if (threads == 1) singleThreadNs = result.stepNs;
+                    if (singleThreadNs > 0.0) result.speedup = singleThreadNs / result.stepNs;
+
+                    printResult(result);
+                    results.push_back(result);
+                }
+            }
+        }
+
+        if (scene == "solar" && (options.filter.empty() || string("checkForEclipse/solar").find(options.filter) != string::npos)) {
+            results.push_back(runEclipseCase(options));
+            printResult(results.back());
+        }
+    }
+
+    for (auto body : bodies) {
+        delete body;
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (!writeJson(options.jsonPath, results, options)) {
+            cout << "Could not write " << options.jsonPath << endl;
+            return 1;
+        }
+        cout << "Results written to " << options.jsonPath << endl;
+    }
+
+    return 0;
+}
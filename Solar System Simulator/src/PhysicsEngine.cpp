@@ -1,37 +1,348 @@
 #include "PhysicsEngine.h"
-#include <GLFW/glfw3.h>
+#include "Profiler.h"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 
 using namespace std;
 
-PhysicsEngine::PhysicsEngine() {}
+const float G = 0.01f; // Gravity strength
+const float moonEscapeDistance = 5.0f; // Distance from Earth before Moon fills Sun's gravity
+const float minGravityDistance = 0.01f; // Pairs closer than this are ignored
+const float timestepAccuracy = 0.2f; // Block timestep criteria, smaller gives shorter steps
+const int minParallelBodies = 256; // Below this the worker threads cost more than they save
 
-void PhysicsEngine::updatePhysics(vector<CelestialBody*>& bodies, float deltaTime)
+PhysicsEngine::PhysicsEngine()
+    : gravityMode(GRAVITY_DIRECT), openingAngle(0.5f), gravityKernel(detectBestKernel()), integrator(INTEGRATOR_LEAPFROG), blockTimesteps(false), forceEvaluations(0), gravityInteractions(0),
+      sunId(-1), moonId(-1), moonParentId(-1), clock(&ownClock),
+      threadPool(ThreadPool::getHardwareThreads()), lastCollisionTime(0.0f) {}
+
+void PhysicsEngine::setGravityMode(GravityMode mode) {
+    gravityMode = mode;
+}
+
+GravityMode PhysicsEngine::getGravityMode() const {
+    return gravityMode;
+}
+
+void PhysicsEngine::setOpeningAngle(float theta) {
+    openingAngle = glm::clamp(theta, 0.0f, 2.0f);
+}
+
+float PhysicsEngine::getOpeningAngle() const {
+    return openingAngle;
+}
+
+bool PhysicsEngine::setGravityKernel(GravityKernel kernel) {
+    if (!isKernelSupported(kernel)) return false;
+
+    gravityKernel = kernel;
+    return true;
+}
+
+GravityKernel PhysicsEngine::getGravityKernel() const {
+    return gravityKernel;
+}
+
+void PhysicsEngine::setIntegrator(Integrator newIntegrator) {
+    integrator = newIntegrator;
+}
+
+Integrator PhysicsEngine::getIntegrator() const {
+    return integrator;
+}
+
+void PhysicsEngine::setBlockTimesteps(bool enabled) {
+    blockTimesteps = enabled;
+    resetTimestepState();
+}
+
+void PhysicsEngine::resetTimestepState() {
+    timestepLevels.clear();
+}
+
+bool PhysicsEngine::getBlockTimesteps() const {
+    return blockTimesteps;
+}
+
+long long PhysicsEngine::getForceEvaluations() const {
+    return forceEvaluations;
+}
+
+long long PhysicsEngine::getGravityInteractions() const {
+    return gravityInteractions;
+}
+
+void PhysicsEngine::setClock(SimulationClock* simulationClock) {
+    clock = simulationClock ? simulationClock : &ownClock;
+}
+
+SimulationClock& PhysicsEngine::getClock() {
+    return *clock;
+}
+
+void PhysicsEngine::setThreadCount(int threadCount) {
+    threadPool.setThreadCount(threadCount);
+}
+
+int PhysicsEngine::getThreadCount() const {
+    return threadPool.getThreadCount();
+}
+
+PhysicsSettings PhysicsEngine::getSettings() const {
+    PhysicsSettings settings;
+    settings.gravityMode = gravityMode;
+    settings.openingAngle = openingAngle;
+    settings.gravityKernel = gravityKernel;
+    settings.integrator = integrator;
+    settings.blockTimesteps = blockTimesteps;
+    settings.threadCount = getThreadCount();
+    return settings;
+}
+
+void PhysicsEngine::applySettings(const PhysicsSettings& settings) {
+    setGravityMode(settings.gravityMode);
+    setOpeningAngle(settings.openingAngle);
+    setGravityKernel(settings.gravityKernel);
+    setIntegrator(settings.integrator);
+
+    // Both are expensive to change, the levels are rebuilt and the workers restarted
+    if (settings.blockTimesteps != blockTimesteps) setBlockTimesteps(settings.blockTimesteps);
+    if (settings.threadCount != getThreadCount()) setThreadCount(settings.threadCount);
+}
+
+// Splits the bodies across the worker threads, small scenes run on the calling thread
+void PhysicsEngine::forEachBodyRange(int count, const function<void(int, int, int)>& task)
 {
-    for (auto& b : bodies) {
-        b->resetAcceleration();
-        b->isInShadow = false;
-        b->shadowIntensity = 1.0f; // Full brightness by default
+    if (count < minParallelBodies) {
+        task(0, count, 0);
+        return;
     }
 
-    CelestialBody* moon = nullptr;
-    CelestialBody* earth = nullptr;
-    CelestialBody* sun = nullptr;
+    threadPool.parallelFor(count, task);
+}
 
-    const float G = 0.01f; // Gravity strength
-    const float moonEscapeDistance = 5.0f; // Distance from Earth before Moon fills Sun's gravity
+// Remembers the Sun, the Moon and the body it orbits by their stable IDs so the physics never has to search for them
+void PhysicsEngine::resolveSpecialBodies(const BodyStore& store, const vector<CelestialBody*>& bodies)
+{
+    sunId = -1;
+    moonId = -1;
+    moonParentId = -1;
 
-    for (auto& body : bodies) {
-        if (body->name == "Moon") moon = body;
-        if (body->name == "Earth") earth = body;
-        if (body->name == "Sun") sun = body;
+    for (const auto& body : bodies) {
+        unsigned int flags = store.flags[body->index()];
 
-        if (moon && earth && sun) break;
+        if (sunId < 0 && (flags & BODY_STAR)) {
+            sunId = body->id;
+        }
+        if (moonId < 0 && (flags & BODY_MOON) && body->parentBody) {
+            moonId = body->id;
+            moonParentId = body->parentBody->id;
+        }
+    }
+
+    resetTimestepState();
+}
+
+void PhysicsEngine::updatePhysics(BodyStore& store, vector<CelestialBody*>& bodies, float deltaTime)
+{
+    ProfileScope profile("updatePhysics");
+
+    int moon = store.indexOf(moonId);
+    int earth = store.indexOf(moonParentId);
+    int sun = store.indexOf(sunId);
+
+    handleCollisions(store, bodies);
+
+    // Check for eclipse (Moon between Sun and Earth)
+    if (sun >= 0 && earth >= 0 && moon >= 0) {
+        checkForEclipse(bodies[sun], bodies[earth], bodies[moon]);
+    }
+
+    if (blockTimesteps) {
+        blockStep(store, deltaTime, moon, earth, sun);
+    }
+    else {
+        const SplittingScheme& scheme = getSplittingScheme(integrator);
+
+        for (int stage = 0; stage < scheme.stages; stage++) {
+            ProfileScope substep("Substep");
+            drift(store, static_cast<float>(scheme.drift[stage] * deltaTime));
+            store.syncForcePositions();
+            computeAccelerations(store, moon, earth, sun);
+            kick(store, static_cast<float>(scheme.kick[stage] * deltaTime));
+        }
+        drift(store, static_cast<float>(scheme.drift[scheme.stages] * deltaTime));
+    }
+
+    clock->advance(deltaTime);
+
+    for (auto& b : bodies)
+        b->updateVisualState(deltaTime);
+}
+
+// Hierarchical kick-drift-kick leapfrog. Level L bodies take steps of deltaTime / 2^L and drift once per step of
+// their own. Time jumps from one step boundary to the next, and only the bodies finishing a step get new forces,
+// pulled by the others at positions predicted along their velocities. All levels line up at the end of deltaTime
+void PhysicsEngine::blockStep(BodyStore& store, float deltaTime, int moon, int earth, int sun)
+{
+    ProfileScope profile("Block step");
+
+    int count = store.size();
+    if (count == 0) return;
+
+    // New scene, or block steps were just switched on: every body starts from fresh forces
+    if (static_cast<int>(timestepLevels.size()) != count) {
+        store.syncForcePositions();
+        computeAccelerations(store, moon, earth, sun);
+        previousAx = store.ax;
+        previousAy = store.ay;
+        previousAz = store.az;
+
+        timestepLevels.assign(count, 0);
+        for (int i = 0; i < count; i++) {
+            timestepLevels[i] = chooseTimestepLevel(store, i, deltaTime, 0.0f);
+        }
+    }
+
+    // Time inside the block counts steps of the finest possible level
+    const int blockTicks = 1 << MAX_TIMESTEP_LEVEL;
+    float tickDelta = deltaTime / blockTicks;
+
+    stepStarts.assign(count, 0);
+    predictionTimes.assign(count, 0.0f);
+
+    // First half kick of every body, with the forces from the end of its last step
+    int movingCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (store.flags[i] & BODY_STATIC) continue;
+
+        float halfStep = 0.5f * (blockTicks >> timestepLevels[i]) * tickDelta;
+        store.vx[i] += store.ax[i] * halfStep;
+        store.vy[i] += store.ay[i] * halfStep;
+        store.vz[i] += store.az[i] * halfStep;
+        movingCount++;
+    }
+
+    int now = 0;
+    while (now < blockTicks && movingCount > 0) {
+        // Next time any body finishes its step
+        int next = blockTicks;
+        for (int i = 0; i < count; i++) {
+            if (store.flags[i] & BODY_STATIC) continue;
+            next = min(next, stepStarts[i] + (blockTicks >> timestepLevels[i]));
+        }
+        now = next;
+
+        // Bodies finishing their step drift over the whole of it, the rest are only predicted
+        activeBodies.clear();
+        bool anyPredicted = false;
+        for (int i = 0; i < count; i++) {
+            predictionTimes[i] = 0.0f;
+            if (store.flags[i] & BODY_STATIC) continue;
+
+            int elapsed = now - stepStarts[i];
+            if (elapsed == (blockTicks >> timestepLevels[i])) {
+                float step = elapsed * tickDelta;
+                store.x[i] += store.vx[i] * step;
+                store.y[i] += store.vy[i] * step;
+                store.z[i] += store.vz[i] * step;
+                activeBodies.push_back(i);
+            }
+            else {
+                predictionTimes[i] = elapsed * tickDelta;
+                anyPredicted = true;
+            }
+        }
+
+        if (anyPredicted) {
+            store.predictForcePositions(predictionTimes);
+        }
+        else {
+            store.syncForcePositions();
+        }
+
+        // When every body is due, the pair kernel is cheaper than gathering for each target
+        bool allActive = static_cast<int>(activeBodies.size()) == movingCount;
+        computeAccelerations(store, moon, earth, sun, allActive ? nullptr : &activeBodies);
+
+        for (int i : activeBodies) {
+            float step = (blockTicks >> timestepLevels[i]) * tickDelta;
+
+            store.vx[i] += store.ax[i] * 0.5f * step;
+            store.vy[i] += store.ay[i] * 0.5f * step;
+            store.vz[i] += store.az[i] * 0.5f * step;
+
+            // Jerk from the change in acceleration over the step
+            glm::vec3 jerk = (store.getAcceleration(i) - glm::vec3(previousAx[i], previousAy[i], previousAz[i])) / step;
+            previousAx[i] = store.ax[i];
+            previousAy[i] = store.ay[i];
+            previousAz[i] = store.az[i];
+
+            // Finer levels are allowed at once, coarser ones only where their steps line up with now
+            int level = chooseTimestepLevel(store, i, deltaTime, glm::length(jerk));
+            int current = timestepLevels[i];
+            while (level < current && now % (blockTicks >> (current - 1)) == 0) {
+                current--;
+            }
+            timestepLevels[i] = level > current ? level : current;
+            stepStarts[i] = now;
+
+            // The next step starts right away, except at the end of the block
+            if (now < blockTicks) {
+                float halfStep = 0.5f * (blockTicks >> timestepLevels[i]) * tickDelta;
+                store.vx[i] += store.ax[i] * halfStep;
+                store.vy[i] += store.ay[i] * halfStep;
+                store.vz[i] += store.az[i] * halfStep;
+            }
+        }
+    }
+
+    // Every body is at the end of the block, later readers use the state itself
+    store.syncForcePositions();
+}
+
+// Level whose step is short enough for both the acceleration and the jerk criteria
+int PhysicsEngine::chooseTimestepLevel(const BodyStore& store, int i, float deltaTime, float jerk) const
+{
+    float acceleration = glm::length(store.getAcceleration(i));
+    if (acceleration <= 0.0f || deltaTime <= 0.0f) return 0;
+
+    // Time to move about one body radius from rest, and time for the acceleration to change by a fraction of itself
+    float step = timestepAccuracy * sqrt(store.radius[i] / acceleration);
+    if (jerk > 0.0f) {
+        step = min(step, timestepAccuracy * acceleration / jerk);
+    }
+
+    if (step >= deltaTime) return 0;
+
+    int level = static_cast<int>(ceil(log2(deltaTime / step)));
+    return min(level, MAX_TIMESTEP_LEVEL);
+}
+
+// Forces at the store's force positions, sync or predict them first
+void PhysicsEngine::computeAccelerations(BodyStore& store, int moon, int earth, int sun, const vector<int>* targets)
+{
+    ProfileScope profile("Gravity");
+
+    bool moonIsTarget = true;
+    forceEvaluations += targets ? targets->size() : store.size();
+
+    if (targets) {
+        for (int i : *targets) {
+            store.ax[i] = 0.0f;
+            store.ay[i] = 0.0f;
+            store.az[i] = 0.0f;
+        }
+        moonIsTarget = find(targets->begin(), targets->end(), moon) != targets->end();
+    }
+    else {
+        store.resetAccelerations();
     }
 
     // This changes normal gravity for the Moon to ensure stable orbit around Earth
-    if (moon && earth) {
-        glm::vec3 toEarth = earth->position - moon->position;
+    if (moonIsTarget && moon >= 0 && earth >= 0) {
+        glm::vec3 toEarth = store.getForcePosition(earth) - store.getForcePosition(moon);
         float distToEarth = glm::length(toEarth);
 
         if (distToEarth <= moonEscapeDistance) {
@@ -42,102 +353,274 @@ void PhysicsEngine::updatePhysics(vector<CelestialBody*>& bodies, float deltaTim
 
                 float orbitForce = 1.0f * (distToEarth - desiredOrbitRadius);
 
-                glm::vec3 currentVelRelative = moon->velocity - earth->velocity;
+                glm::vec3 currentVelRelative = store.getVelocity(moon) - store.getVelocity(earth);
                 glm::vec3 tangentDir = glm::normalize(glm::cross(toEarth, glm::vec3(0.0f, 1.0f, 0.0f)));
                 float currentTangential = glm::dot(currentVelRelative, tangentDir);
                 float desiredTangential = 1.0f; // Orbital speed around Earth
 
                 float tangentialForce = 1.5f * (desiredTangential - currentTangential);
 
-                moon->acceleration += forceDir * orbitForce;
-                moon->acceleration += tangentDir * tangentialForce;
+                store.addAcceleration(moon, forceDir * orbitForce);
+                store.addAcceleration(moon, tangentDir * tangentialForce);
             }
         }
     }
 
-    // Normal gravity
-    for (int i = 0; i < bodies.size(); i++) {
-        CelestialBody* A = bodies[i];
+    if (gravityMode == GRAVITY_BARNES_HUT) {
+        applyBarnesHutGravity(store, moon, earth, sun, targets);
+        return;
+    }
+
+    // Every evaluated body sums the pull of every other body
+    gravityInteractions += static_cast<long long>(targets ? targets->size() : store.size()) * max(store.size() - 1, 0);
+    if (targets) {
+        applyTargetedGravity(store, moon, earth, sun, *targets);
+    }
+    else {
+        applyDirectGravity(store, moon, earth, sun);
+    }
+}
+
+void PhysicsEngine::drift(BodyStore& store, float deltaTime)
+{
+    if (deltaTime == 0.0f) return;
+
+    int count = store.size();
 
-        for (int j = 0; j < bodies.size(); j++) {
-            if (i == j) continue;
-            CelestialBody* B = bodies[j];
+    for (int i = 0; i < count; i++) {
+        if (store.flags[i] & BODY_STATIC) continue;
 
-            if (A->name == "Moon" && earth && glm::length(A->position - earth->position) <= moonEscapeDistance && (B->name == "Earth" || B->name == "Sun")) { continue; }
-            if (B->name == "Moon" && earth && glm::length(B->position - earth->position) <= moonEscapeDistance && (A->name == "Earth" || A->name == "Sun")) { continue; }
+        store.x[i] += store.vx[i] * deltaTime;
+        store.y[i] += store.vy[i] * deltaTime;
+        store.z[i] += store.vz[i] * deltaTime;
+    }
+}
 
-            glm::vec3 dir = B->position - A->position;
-            float dist = glm::length(dir);
+void PhysicsEngine::kick(BodyStore& store, float deltaTime)
+{
+    int count = store.size();
 
-            if (dist < 0.01f) { continue; }
+    for (int i = 0; i < count; i++) {
+        if (store.flags[i] & BODY_STATIC) continue;
 
-            glm::vec3 forceDir = glm::normalize(dir);
+        store.vx[i] += store.ax[i] * deltaTime;
+        store.vy[i] += store.ay[i] * deltaTime;
+        store.vz[i] += store.az[i] * deltaTime;
+    }
+}
 
-            float force = G * A->mass * B->mass / (dist * dist);
-            float distanceMultiplier = 1.0f / (dist * 0.005f); // Greater pull strength the closer planets get (the smaller the number)
+// Direct summation over every pair of bodies with the selected kernel
+void PhysicsEngine::applyDirectGravity(BodyStore& store, int moon, int earth, int sun)
+{
+    GravitySources sources;
+    sources.x = store.forceX();
+    sources.y = store.forceY();
+    sources.z = store.forceZ();
+    sources.mass = store.mass.data();
+    sources.count = store.size();
+    sources.sun = sun;
+    sources.G = G;
+    sources.minDistanceSq = minGravityDistance * minGravityDistance;
+
+    int count = sources.count;
+    int threads = threadPool.getThreadCount();
+    float* ax = store.ax.data();
+    float* ay = store.ay.data();
+    float* az = store.az.data();
+
+    if (count < minParallelBodies || threads == 1) {
+        runGravityKernel(gravityKernel, sources, 0, count, ax, ay, az);
+    }
+    else {
+        // The opposite pulls land on bodies owned by other threads, so every thread fills its own buffer
+        size_t bufferSize = static_cast<size_t>(count) * 3;
+        if (accumulationBuffers.size() < bufferSize * threads) {
+            accumulationBuffers.resize(bufferSize * threads);
+        }
 
-            if (A->name != "Sun" && B->name != "Sun") {
-                if (dist < 7.0f) {
-                    if (A->mass < B->mass) {
-                        glm::vec3 accelerationA = forceDir * (force / A->mass) * distanceMultiplier;
-                        A->acceleration += accelerationA;
-                    }
-                    else {
-                        glm::vec3 accelerationB = -forceDir * (force / B->mass) * distanceMultiplier;
-                        B->acceleration += accelerationB;
-                    }
-                }
-                else {
-                    glm::vec3 accelerationA = forceDir * (force / A->mass);
-                    glm::vec3 accelerationB = -forceDir * (force / B->mass);
+        // One band of rows with about the same number of pairs per thread
+        threadPool.parallelFor(threads, [&](int part, int, int) {
+            float* buffer = accumulationBuffers.data() + bufferSize * part;
+            fill(buffer, buffer + bufferSize, 0.0f);
 
-                    A->acceleration += accelerationA;
-                    B->acceleration += accelerationB;
+            runGravityKernel(gravityKernel, sources, pairRowSplit(count, part, threads), pairRowSplit(count, part + 1, threads),
+                             buffer, buffer + count, buffer + 2 * count);
+        });
+
+        // Buffers are always added in the same order, so the result only depends on the thread count
+        threadPool.parallelFor(count, [&](int begin, int end, int) {
+            for (int part = 0; part < threads; part++) {
+                const float* buffer = accumulationBuffers.data() + bufferSize * part;
+
+                for (int i = begin; i < end; i++) {
+                    ax[i] += buffer[i];
+                    ay[i] += buffer[count + i];
+                    az[i] += buffer[2 * count + i];
                 }
             }
-            else {
-                glm::vec3 accelerationA = forceDir * (force / A->mass);
-                A->acceleration += accelerationA;
-            }
+        });
+    }
+
+    // Moon pairs with Earth and Sun are left to the orbit control while the Moon is held around Earth
+    bool moonHeld = moon >= 0 && earth >= 0 && glm::length(store.getForcePosition(moon) - store.getForcePosition(earth)) <= moonEscapeDistance;
+
+    if (moonHeld) {
+        store.addAcceleration(moon, -pairAcceleration(sources, moon, earth));
+        store.addAcceleration(earth, -pairAcceleration(sources, earth, moon));
+
+        if (sun >= 0) {
+            store.addAcceleration(moon, -pairAcceleration(sources, moon, sun));
+            store.addAcceleration(sun, -pairAcceleration(sources, sun, moon));
         }
     }
+}
 
-    handleCollisions(bodies);
+// Direct summation for only some of the bodies, every pair is visited from the target's side
+void PhysicsEngine::applyTargetedGravity(BodyStore& store, int moon, int earth, int sun, const vector<int>& targets)
+{
+    GravitySources sources;
+    sources.x = store.forceX();
+    sources.y = store.forceY();
+    sources.z = store.forceZ();
+    sources.mass = store.mass.data();
+    sources.count = store.size();
+    sources.sun = sun;
+    sources.G = G;
+    sources.minDistanceSq = minGravityDistance * minGravityDistance;
+
+    float* ax = store.ax.data();
+    float* ay = store.ay.data();
+    float* az = store.az.data();
+
+    forEachBodyRange(static_cast<int>(targets.size()), [&](int begin, int end, int) {
+        runGatherKernel(gravityKernel, sources, targets.data() + begin, end - begin, ax, ay, az);
+    });
+
+    // Same Moon exceptions as applyDirectGravity, for whichever of the three are targets
+    bool moonHeld = moon >= 0 && earth >= 0 && glm::length(store.getForcePosition(moon) - store.getForcePosition(earth)) <= moonEscapeDistance;
+    if (!moonHeld) return;
+
+    for (int i : targets) {
+        if (i == moon) {
+            store.addAcceleration(moon, -pairAcceleration(sources, moon, earth));
+            if (sun >= 0) store.addAcceleration(moon, -pairAcceleration(sources, moon, sun));
+        }
+        else if (i == earth) {
+            store.addAcceleration(earth, -pairAcceleration(sources, earth, moon));
+        }
+        else if (i == sun) {
+            store.addAcceleration(sun, -pairAcceleration(sources, sun, moon));
+        }
+    }
+}
 
-    // Check for eclipse (Moon between Sun and Earth)
-    if (sun && earth && moon) {
-        checkForEclipse(sun, earth, moon);
+// Barnes-Hut gravity: distant groups of bodies are replaced by their center of mass
+void PhysicsEngine::applyBarnesHutGravity(BodyStore& store, int moon, int earth, int sun, const vector<int>* targets)
+{
+    int count = store.size();
+
+    octree.build(store);
+
+    GravitySources sources;
+    sources.x = store.forceX();
+    sources.y = store.forceY();
+    sources.z = store.forceZ();
+    sources.mass = store.mass.data();
+    sources.count = count;
+    sources.sun = sun;
+    sources.G = G;
+    sources.minDistanceSq = minGravityDistance * minGravityDistance;
+
+    // While the Moon is held around Earth, the Moon-Earth-Sun pairs are left to the orbit control above
+    bool moonHeld = moon >= 0 && earth >= 0 && glm::length(store.getForcePosition(moon) - store.getForcePosition(earth)) <= moonEscapeDistance;
+
+    // Bodies the tree walk computes, the held Moon and Earth are summed exactly below
+    barnesHutTargets.assign(count, targets ? 0 : 1);
+    if (targets) {
+        for (int i : *targets) barnesHutTargets[i] = 1;
     }
 
-    for (auto& b : bodies)
-        b->updatePosition(deltaTime);
+    vector<int> heldBodies;
+    if (moonHeld) {
+        for (int i : { moon, earth }) {
+            if (!barnesHutTargets[i]) continue;
+            heldBodies.push_back(i);
+            barnesHutTargets[i] = 0;
+        }
+    }
+
+    BarnesHutParameters parameters;
+    parameters.kernel = gravityKernel;
+    parameters.theta = openingAngle;
+    parameters.G = G;
+    parameters.minDistance = minGravityDistance;
+    parameters.sun = sun;
+    parameters.isTarget = barnesHutTargets.data();
+
+    // One set of list buffers per chunk, every chunk owns the groups and so the bodies it writes
+    if (walkBuffers.size() < static_cast<size_t>(threadPool.getThreadCount())) {
+        walkBuffers.resize(threadPool.getThreadCount());
+    }
+
+    atomic<long long> interactions(0);
+    float* ax = store.ax.data();
+    float* ay = store.ay.data();
+    float* az = store.az.data();
+
+    forEachBodyRange(octree.getGroupCount(), [&](int begin, int end, int chunk) {
+        interactions += octree.accumulateGroups(begin, end, parameters, walkBuffers[chunk], ax, ay, az);
+    });
+
+    for (int i : heldBodies) {
+        glm::vec3 pull(0.0f);
+
+        // Exact sum with the direct kernels' force law, minus the pairs the orbit control owns
+        for (int j = 0; j < count; j++) {
+            if (i == moon && (j == earth || j == sun)) continue;
+            if (i == earth && j == moon) continue;
+
+            pull += pairAcceleration(sources, i, j);
+        }
+        store.addAcceleration(i, pull);
+        interactions += count - 1;
+    }
+
+    gravityInteractions += interactions;
 }
 
 // Check if a Moon is between planet and Sun and apply a shadow
 void PhysicsEngine::checkForEclipse(CelestialBody* sun, CelestialBody* earth, CelestialBody* moon)
 {
+    ProfileScope profile("checkForEclipse");
+
     earth->isInShadow = false;
     earth->shadowIntensity = 1.0f;
 
-    glm::vec3 sunToEarth = earth->position - sun->position;
+    glm::vec3 sunPosition = sun->getPosition();
+    glm::vec3 earthPosition = earth->getPosition();
+    glm::vec3 moonPosition = moon->getPosition();
+    float sunRadius = sun->getRadius();
+    float moonRadius = moon->getRadius();
+
+    glm::vec3 sunToEarth = earthPosition - sunPosition;
     float sunEarthDistance = glm::length(sunToEarth);
     glm::vec3 sunToEarthDir = glm::normalize(sunToEarth);
 
-    glm::vec3 sunToMoon = moon->position - sun->position;
+    glm::vec3 sunToMoon = moonPosition - sunPosition;
 
     float projection = glm::dot(sunToMoon, sunToEarthDir);
 
     // Check if Moon is between Sun and Earth
-    if (projection > -moon->radius && projection < sunEarthDistance + moon->radius) {
-        glm::vec3 closestPoint = sun->position + sunToEarthDir * projection;
+    if (projection > -moonRadius && projection < sunEarthDistance + moonRadius) {
+        glm::vec3 closestPoint = sunPosition + sunToEarthDir * projection;
 
-        float distanceToLine = glm::length(moon->position - closestPoint);
+        float distanceToLine = glm::length(moonPosition - closestPoint);
 
-        float sunAngularRadius = sun->radius / glm::length(sunToEarth);
-        float moonAngularRadius = moon->radius / glm::length(moon->position - earth->position);
+        float sunAngularRadius = sunRadius / glm::length(sunToEarth);
+        float moonAngularRadius = moonRadius / glm::length(moonPosition - earthPosition);
 
         // Calculate shadow parameters based on alignment quality
-        float maxShadowDistance = moon->radius * 2.0f; // Shadow area projected on Earth
+        float maxShadowDistance = moonRadius * 2.0f; // Shadow area projected on Earth
         float alignment = 1.0f - glm::clamp(distanceToLine / maxShadowDistance, 0.0f, 1.0f);
 
         if (alignment > 0.3f) {
@@ -152,68 +635,78 @@ void PhysicsEngine::checkForEclipse(CelestialBody* sun, CelestialBody* earth, Ce
     }
 }
 
-void PhysicsEngine::handleCollisions(vector<CelestialBody*>& bodies) {
-    // Check all pairs of bodies for collisions
-    for (int i = 0; i < bodies.size(); i++) {
-        for (int j = i + 1; j < bodies.size(); j++) {
-            if (checkCollision(bodies[i], bodies[j])) {
-                resolveCollision(bodies[i], bodies[j]);
-            }
+void PhysicsEngine::handleCollisions(BodyStore& store, vector<CelestialBody*>& bodies) {
+    ProfileScope profile("handleCollisions");
+
+    // Only pairs that overlap along x are checked
+    const vector<pair<int, int>>& candidates = broadPhase.findCandidates(store, 0.0f);
+
+    for (const auto& candidate : candidates) {
+        if (checkCollision(store, candidate.first, candidate.second)) {
+            resolveCollision(store, bodies, candidate.first, candidate.second);
         }
     }
 }
 
-bool PhysicsEngine::checkCollision(CelestialBody* a, CelestialBody* b) {
-    float distance = glm::length(a->position - b->position);
-    float minDistance = a->radius + b->radius;
-
+bool PhysicsEngine::checkCollision(const BodyStore& store, int a, int b) {
     float collisionMargin = 0.1f; // Distance before a collision occures
-    
-    return distance < (minDistance - collisionMargin);
+    float minDistance = store.radius[a] + store.radius[b] - collisionMargin;
+    if (minDistance <= 0.0f) return false;
+
+    // Squared distances, no square root for the pairs that do not touch
+    glm::vec3 offset = store.getPosition(a) - store.getPosition(b);
+    return glm::dot(offset, offset) < minDistance * minDistance;
 }
 
-void PhysicsEngine::resolveCollision(CelestialBody* a, CelestialBody* b) {
-    bool aIsSun = (a->name == "Sun");
-    bool bIsSun = (b->name == "Sun");
+void PhysicsEngine::resolveCollision(BodyStore& store, vector<CelestialBody*>& bodies, int a, int b) {
+    bool aIsSun = (store.flags[a] & BODY_STAR) != 0;
+    bool bIsSun = (store.flags[b] & BODY_STAR) != 0;
 
     // Handle Sun collision specially
     if (aIsSun || bIsSun) {
-        CelestialBody* sun = aIsSun ? a : b;
-        CelestialBody* planet = aIsSun ? b : a;
+        int sun = aIsSun ? a : b;
+        int planet = aIsSun ? b : a;
+
+        cout << "SUN COLLISION DETECTED with " << bodies[planet]->name << endl;
 
-        cout << "SUN COLLISION DETECTED with " << planet->name << endl;
+        glm::vec3 sunPosition = store.getPosition(sun);
+        glm::vec3 planetPosition = store.getPosition(planet);
+        glm::vec3 planetVelocity = store.getVelocity(planet);
+        glm::vec3 initialVelocity = planetVelocity;
 
-        glm::vec3 collisionNormal = glm::normalize(planet->position - sun->position);
+        glm::vec3 collisionNormal = glm::normalize(planetPosition - sunPosition);
 
-        float currentDistance = glm::length(planet->position - sun->position);
-        float desiredDistance = sun->radius + planet->radius + 2.0f;
+        float currentDistance = glm::length(planetPosition - sunPosition);
+        float desiredDistance = store.radius[sun] + store.radius[planet] + 2.0f;
         float penetration = desiredDistance - currentDistance;
 
         if (penetration > 0) {
-            planet->position = sun->position + collisionNormal * desiredDistance;
+            store.addDisplacement(planet, sunPosition + collisionNormal * desiredDistance - planetPosition);
         }
 
-        glm::vec3 relativeVelocity = planet->velocity - sun->velocity;
+        glm::vec3 relativeVelocity = planetVelocity - store.getVelocity(sun);
         float velocityTowardSun = glm::dot(relativeVelocity, collisionNormal);
 
         if (velocityTowardSun < 0) {
 
-            planet->velocity -= collisionNormal * velocityTowardSun;
+            planetVelocity -= collisionNormal * velocityTowardSun;
 
             glm::vec3 tangentDir = glm::normalize(glm::cross(collisionNormal, glm::vec3(0.0f, 1.0f, 0.0f)));
             float orbitSpeed = glm::length(relativeVelocity) * 0.2f; // Collision strength
-            planet->velocity += tangentDir * orbitSpeed;
+            planetVelocity += tangentDir * orbitSpeed;
 
             float maxCollisionSpeed = 10.0f; // Max collision speed with Sun
-            if (glm::length(planet->velocity) > maxCollisionSpeed) {
-                planet->velocity = glm::normalize(planet->velocity) * maxCollisionSpeed;
+            if (glm::length(planetVelocity) > maxCollisionSpeed) {
+                planetVelocity = glm::normalize(planetVelocity) * maxCollisionSpeed;
             }
+
+            store.addVelocity(planet, planetVelocity - initialVelocity);
         }
 
-        planet->startCollisionAnimation();
+        bodies[planet]->startCollisionAnimation();
         static float sunCollisionCooldown = 0.0f;
         static float lastSunCollisionTime = 0.0f;
-        float currentTime = static_cast<float>(glfwGetTime());
+        float currentTime = static_cast<float>(clock->now());
 
         if (currentTime - lastSunCollisionTime < 1.0f) {
             return;
@@ -223,36 +716,48 @@ void PhysicsEngine::resolveCollision(CelestialBody* a, CelestialBody* b) {
         return;
     }
 
+    bool aIsStatic = store.isStatic(a);
+    bool bIsStatic = store.isStatic(b);
+    float massA = store.mass[a];
+    float massB = store.mass[b];
+    glm::vec3 posA = store.getPosition(a);
+    glm::vec3 posB = store.getPosition(b);
+    glm::vec3 velA = store.getVelocity(a);
+    glm::vec3 velB = store.getVelocity(b);
+    glm::vec3 initialPosA = posA;
+    glm::vec3 initialPosB = posB;
+    glm::vec3 initialVelA = velA;
+    glm::vec3 initialVelB = velB;
+
     // Regular planet collision
-    glm::vec3 collisionNormal = glm::normalize(a->position - b->position);
-    glm::vec3 relativeVelocity = a->velocity - b->velocity;
+    glm::vec3 collisionNormal = glm::normalize(posA - posB);
+    glm::vec3 relativeVelocity = velA - velB;
     float velocityAlongNormal = glm::dot(relativeVelocity, collisionNormal);
 
     if (velocityAlongNormal > 0) return;
 
-    float overlap = (a->radius + b->radius) - glm::length(a->position - b->position);
+    float overlap = (store.radius[a] + store.radius[b]) - glm::length(posA - posB);
 
     if (overlap > 0) {
-        float totalMass = a->mass + b->mass;
-        float aRatio = b->mass / totalMass;
-        float bRatio = a->mass / totalMass;
+        float totalMass = massA + massB;
+        float aRatio = massB / totalMass;
+        float bRatio = massA / totalMass;
 
         glm::vec3 separation = collisionNormal * overlap;
 
-        if (!a->isStatic) a->position += separation * aRatio * 0.5f;
-        if (!b->isStatic) b->position -= separation * bRatio * 0.5f;
+        if (!aIsStatic) posA += separation * aRatio * 0.5f;
+        if (!bIsStatic) posB -= separation * bRatio * 0.5f;
 
         float safetyMargin = 0.1f;
-        if (!a->isStatic) a->position += collisionNormal * safetyMargin * aRatio;
-        if (!b->isStatic) b->position -= collisionNormal * safetyMargin * bRatio;
+        if (!aIsStatic) posA += collisionNormal * safetyMargin * aRatio;
+        if (!bIsStatic) posB -= collisionNormal * safetyMargin * bRatio;
     }
 
     float restitution = 0.8f;
     float impulseScalar = -(1.0f + restitution) * velocityAlongNormal;
-    impulseScalar /= (1.0f / a->mass + 1.0f / b->mass);
+    impulseScalar /= (1.0f / massA + 1.0f / massB);
 
-    static float lastCollisionTime = 0.0f;
-    float currentTime = static_cast<float>(glfwGetTime());
+    float currentTime = static_cast<float>(clock->now());
     float timeSinceLastCollision = currentTime - lastCollisionTime;
     lastCollisionTime = currentTime;
 
@@ -264,46 +769,52 @@ void PhysicsEngine::resolveCollision(CelestialBody* a, CelestialBody* b) {
     glm::vec3 impulse = collisionNormal * impulseScalar;
 
     // Strength of the collision is calculated by the planets mass
-    if (!a->isStatic) {
-        a->velocity += impulse / a->mass;
+    if (!aIsStatic) {
+        velA += impulse / massA;
     }
-    if (!b->isStatic) {
-        b->velocity -= impulse / b->mass;
+    if (!bIsStatic) {
+        velB -= impulse / massB;
     }
 
     float maxCollisionSpeed = 10.0f; // Max collision speed between planets
 
-    if (!a->isStatic) {
-        float currentSpeed = glm::length(a->velocity);
+    if (!aIsStatic) {
+        float currentSpeed = glm::length(velA);
         if (currentSpeed > maxCollisionSpeed) {
             float damping = 0.7f;
-            a->velocity = glm::normalize(a->velocity) * (maxCollisionSpeed * damping);
+            velA = glm::normalize(velA) * (maxCollisionSpeed * damping);
         }
         else if (currentSpeed > 5.0f) {
-            a->velocity *= 0.9f;
+            velA *= 0.9f;
         }
     }
 
-    if (!b->isStatic) {
-        float currentSpeed = glm::length(b->velocity);
+    if (!bIsStatic) {
+        float currentSpeed = glm::length(velB);
         if (currentSpeed > maxCollisionSpeed) {
             float damping = 0.7f;
-            b->velocity = glm::normalize(b->velocity) * (maxCollisionSpeed * damping);
+            velB = glm::normalize(velB) * (maxCollisionSpeed * damping);
         }
         else if (currentSpeed > 5.0f) {
-            b->velocity *= 0.9f;
+            velB *= 0.9f;
         }
     }
 
     glm::vec3 tangentDir = glm::normalize(glm::cross(collisionNormal, glm::vec3(0.0f, 1.0f, 0.0f)));
     if (glm::length(tangentDir) > 0.1f) {
         float spinStrength = 0.5f;
-        if (!a->isStatic) a->velocity += tangentDir * spinStrength * (b->mass / a->mass);
-        if (!b->isStatic) b->velocity -= tangentDir * spinStrength * (a->mass / b->mass);
+        if (!aIsStatic) velA += tangentDir * spinStrength * (massB / massA);
+        if (!bIsStatic) velB -= tangentDir * spinStrength * (massA / massB);
     }
 
-    a->startCollisionAnimation();
-    b->startCollisionAnimation();
+    // Only the changes go back, whatever the collision leaves alone keeps its full precision
+    store.addDisplacement(a, posA - initialPosA);
+    store.addDisplacement(b, posB - initialPosB);
+    store.addVelocity(a, velA - initialVelA);
+    store.addVelocity(b, velB - initialVelB);
+
+    bodies[a]->startCollisionAnimation();
+    bodies[b]->startCollisionAnimation();
 
-    cout << "PLANET COLLISION: " << a->name << " hit " << b->name << endl;
+    cout << "PLANET COLLISION: " << bodies[a]->name << " hit " << bodies[b]->name << endl;
 }
\ No newline at end of file
@@ -3,20 +3,118 @@
 
 #include <vector>
 #include <glm/glm.hpp>
+#include "BodyStore.h"
 #include "CelestialBody.h"
+#include "Octree.h"
+#include "SweepAndPrune.h"
+#include "GravityKernels.h"
+#include "ThreadPool.h"
+#include "Integrator.h"
+#include "SimulationClock.h"
+#include "PhysicsSettings.h"
 
 using namespace std;
 
+const int MAX_TIMESTEP_LEVEL = 10; // Finest block step is 1/1024 of the substep
+
 class PhysicsEngine {
 public:
     PhysicsEngine();
 
-    void handleCollisions(vector<CelestialBody*>& bodies);
-    bool checkCollision(CelestialBody* a, CelestialBody* b);
-    void resolveCollision(CelestialBody* a, CelestialBody* b);
+    // Body i in the store belongs to bodies[i]
+    void handleCollisions(BodyStore& store, vector<CelestialBody*>& bodies);
+    bool checkCollision(const BodyStore& store, int a, int b);
+    void resolveCollision(BodyStore& store, vector<CelestialBody*>& bodies, int a, int b);
     
-    void updatePhysics(vector<CelestialBody*>& bodies, float deltaTime);
+    // Call after creating a scene, finds the bodies the physics treats specially from their flags
+    void resolveSpecialBodies(const BodyStore& store, const vector<CelestialBody*>& bodies);
+
+    void updatePhysics(BodyStore& store, vector<CelestialBody*>& bodies, float deltaTime);
     void checkForEclipse(class CelestialBody* sun, class CelestialBody* earth, class CelestialBody* moon);
+
+    void setGravityMode(GravityMode mode);
+    GravityMode getGravityMode() const;
+
+    // Barnes-Hut opening angle: 0 is exact, larger values are faster but less accurate
+    void setOpeningAngle(float theta);
+    float getOpeningAngle() const;
+
+    // Direct-sum kernel, defaults to the widest one the CPU supports. Returns false if the CPU lacks it
+    bool setGravityKernel(GravityKernel kernel);
+    GravityKernel getGravityKernel() const;
+
+    // Time stepping scheme, higher orders stay accurate with fewer substeps
+    void setIntegrator(Integrator newIntegrator);
+    Integrator getIntegrator() const;
+
+    // Individual power-of-two timesteps per body, replaces the integrator while enabled
+    void setBlockTimesteps(bool enabled);
+    bool getBlockTimesteps() const;
+    // Forgets the block timestep levels, they are chosen again from the state at the next step. Call when the state is replaced
+    void resetTimestepState();
+
+    // Bodies whose forces have been calculated since the engine was created
+    long long getForceEvaluations() const;
+    // Pulls summed since the engine was created, body pairs for direct gravity, body-body and body-cube pairs for Barnes-Hut
+    long long getGravityInteractions() const;
+
+    // Clock read by time based effects and advanced by updatePhysics. nullptr goes back to the engine's own clock
+    void setClock(SimulationClock* simulationClock);
+    SimulationClock& getClock();
+
+    // Threads used for the force calculation, defaults to one per hardware thread
+    void setThreadCount(int threadCount);
+    int getThreadCount() const;
+
+    // All of the settings above at once, only what differs is changed
+    PhysicsSettings getSettings() const;
+    void applySettings(const PhysicsSettings& settings);
+
+private:
+    GravityMode gravityMode;
+    float openingAngle;
+    GravityKernel gravityKernel;
+    Integrator integrator;
+    bool blockTimesteps;
+    long long forceEvaluations;
+    long long gravityInteractions;
+
+    // Stable store IDs of the special bodies, -1 if the scene has none
+    int sunId;
+    int moonId;
+    int moonParentId;
+
+    SimulationClock ownClock;
+    SimulationClock* clock;
+
+    ThreadPool threadPool;
+    vector<float> accumulationBuffers; // Per-thread x, y, z accelerations for the direct sum
+
+    // Block timestep state, indexed like the store
+    vector<int> timestepLevels;
+    vector<float> previousAx, previousAy, previousAz; // Acceleration at each body's last force evaluation
+    vector<int> activeBodies;
+    vector<int> stepStarts; // Tick each body's current step began on, within one block step
+    vector<float> predictionTimes; // How far into its step each body is, for predicting its position
+
+    Octree octree;
+    vector<unsigned char> barnesHutTargets; // Bodies the tree walk computes this evaluation
+    vector<OctreeWalkBuffers> walkBuffers;  // One per thread pool chunk
+    SweepAndPrune broadPhase;
+
+    float lastCollisionTime; // Simulation time of the last planet collision, for damping repeated hits
+
+    friend class Checkpoint;
+
+    void applyDirectGravity(BodyStore& store, int moon, int earth, int sun);
+    void applyTargetedGravity(BodyStore& store, int moon, int earth, int sun, const vector<int>& targets);
+    void applyBarnesHutGravity(BodyStore& store, int moon, int earth, int sun, const vector<int>* targets = nullptr);
+    void computeAccelerations(BodyStore& store, int moon, int earth, int sun, const vector<int>* targets = nullptr);
+    void blockStep(BodyStore& store, float deltaTime, int moon, int earth, int sun);
+    int chooseTimestepLevel(const BodyStore& store, int i, float deltaTime, float jerk) const;
+    void drift(BodyStore& store, float deltaTime);
+    void kick(BodyStore& store, float deltaTime);
+    void forEachBodyRange(int count, const function<void(int, int, int)>& task);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef PHYSICSSETTINGS_H
+#define PHYSICSSETTINGS_H
+
+#include "GravityKernels.h"
+#include "Integrator.h"
+
+enum GravityMode {
+    GRAVITY_DIRECT = 0,     // Every pair of bodies, O(N^2)
+    GRAVITY_BARNES_HUT = 1  // Octree approximation, O(N log N)
+};
+
+// Everything about how the engine steps, can be copied out and applied as one
+struct PhysicsSettings {
+    GravityMode gravityMode;
+    float openingAngle;
+    GravityKernel gravityKernel;
+    Integrator integrator;
+    bool blockTimesteps;
+    int threadCount;
+
+    bool operator==(const PhysicsSettings& other) const = default;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "PhysicsThread.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+static double steadySeconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SimulationSnapshot::SimulationSnapshot()
+    : stepCount(0), resetCount(0), simulationTime(0.0), interpolation(0.0f), publishTime(0.0), timeScale(0.0f), stepDelta(0.0f), settings() {}
+
+SimulationCommand::SimulationCommand()
+    : type(COMMAND_APPLY_IMPULSE), bodyId(-1), vector(0.0f), value(0.0f), settings() {}
+
+PhysicsThread::PhysicsThread(PhysicsEngine& engine, BodyStore& store, vector<CelestialBody*>& bodies, FixedStepScheduler& scheduler)
+    : engine(engine), store(store), bodies(bodies), scheduler(scheduler), stopping(false), timeScale(1.0f), stepCount(0), resetCount(0),
+      scrubStep(-1) {}
+
+PhysicsThread::~PhysicsThread() {
+    stop();
+}
+
+void PhysicsThread::start() {
+    if (worker.joinable()) return;
+
+    initialState = store;
+    history.clear();
+    history.addKeyframe(stepCount, store, bodies, engine, false);
+    publish();
+
+    stopping = false;
+    worker = thread(&PhysicsThread::run, this);
+}
+
+void PhysicsThread::stop() {
+    stopping = true;
+    if (worker.joinable()) worker.join();
+}
+
+void PhysicsThread::setCheckpointPath(const string& path) {
+    checkpointPath = path;
+}
+
+bool PhysicsThread::submit(const SimulationCommand& command) {
+    return commands.push(command);
+}
+
+const SimulationSnapshot& PhysicsThread::readSnapshot(bool& changed) {
+    changed = snapshots.update();
+    return snapshots.readBuffer();
+}
+
+float PhysicsThread::getRenderInterpolation(const SimulationSnapshot& snapshot) {
+    if (snapshot.stepDelta <= 0.0f) return 1.0f;
+
+    // Keeps moving between snapshots at the speed the physics is running
+    double ahead = (steadySeconds() - snapshot.publishTime) * snapshot.timeScale / snapshot.stepDelta;
+    return static_cast<float>(min(1.0, snapshot.interpolation + ahead));
+}
+
+void PhysicsThread::run() {
+    Profiler::setThreadName("Physics");
+    double lastTime = steadySeconds();
+
+    while (!stopping) {
+        double now = steadySeconds();
+        double elapsed = now - lastTime;
+        lastTime = now;
+
+        // Commands first so a new time scale already counts for this frame
+        bool changed = applyCommands();
+
+        // Scrubbing holds the simulation where it is
+        int steps = scrubStep < 0 ? scheduler.advance(elapsed * timeScale) : 0;
+        float stepDelta = static_cast<float>(scheduler.getStepDelta());
+
+        for (int i = 0; i < steps; i++) {
+            if (i > 0) applyCommands();
+
+            for (auto& body : bodies) {
+                body->storePreviousPosition();
+            }
+            engine.updatePhysics(store, bodies, stepDelta);
+            stepCount++;
+            history.recordStep(stepCount, store, bodies, engine);
+        }
+
+        // Commands also show up while paused
+        if (steps > 0 || changed) publish();
+
+        // Nothing due yet, wait instead of spinning
+        if (steps == 0) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+}
+
+// Runs every queued command, returns true if there were any
+bool PhysicsThread::applyCommands() {
+    bool applied = false;
+    SimulationCommand command;
+
+    while (commands.pop(command)) {
+        applyCommand(command);
+        applied = true;
+    }
+    return applied;
+}
+
+void PhysicsThread::applyCommand(const SimulationCommand& command) {
+    switch (command.type) {
+    case COMMAND_APPLY_IMPULSE: {
+        int i = store.indexOf(command.bodyId);
+        if (i < 0 || store.isStatic(i)) break;
+
+        store.addVelocity(i, command.vector);
+        history.addKeyframe(stepCount, store, bodies, engine, true);
+        break;
+    }
+
+    case COMMAND_STOP_BODY: {
+        int i = store.indexOf(command.bodyId);
+        if (i < 0 || store.isStatic(i)) break;
+
+        store.setVelocity(i, glm::vec3(0.0f));
+        history.addKeyframe(stepCount, store, bodies, engine, true);
+        break;
+    }
+
+    case COMMAND_RESET:
+        reset();
+        break;
+
+    case COMMAND_SET_TIME_SCALE:
+        timeScale = max(0.0f, command.value);
+        break;
+
+    case COMMAND_SET_PHYSICS:
+        engine.applySettings(command.settings);
+        // Steps after this can only be integrated again with the new settings
+        history.addKeyframe(stepCount, store, bodies, engine, false);
+        break;
+
+    case COMMAND_SAVE_CHECKPOINT:
+        // Trails belong to the render thread and are left out
+        checkpointWriter.save(checkpointPath, store, bodies, engine, false);
+        cout << "Saving checkpoint at " << engine.getClock().now() << "s to " << checkpointPath << endl;
+        break;
+
+    case COMMAND_LOAD_CHECKPOINT:
+        loadCheckpoint();
+        break;
+
+    case COMMAND_SCRUB:
+        scrubStep = stepsBack(command.value);
+        if (!history.decodePositions(scrubStep, scrubPositions)) scrubStep = -1;
+        break;
+
+    case COMMAND_REWIND:
+        rewind(stepsBack(command.value));
+        break;
+
+    case COMMAND_UNDO:
+        undo();
+        break;
+    }
+}
+
+// Puts the bodies back where they were when the thread started, the bodies themselves are kept
+void PhysicsThread::reset() {
+    store = initialState;
+
+    for (auto& body : bodies) {
+        body->resetVisualState();
+    }
+
+    engine.getClock().reset();
+    scheduler.reset();
+
+    // Timestep levels belong to the old state
+    engine.resetTimestepState();
+
+    resetCount++;
+
+    history.clear();
+    history.addKeyframe(stepCount, store, bodies, engine, false);
+}
+
+void PhysicsThread::loadCheckpoint() {
+    // A save that is still being written has to finish first
+    checkpointWriter.wait();
+
+    string error;
+    if (!Checkpoint::readFile(checkpointPath, checkpointImage)) {
+        cout << "Could not read checkpoint " << checkpointPath << endl;
+        return;
+    }
+    if (!Checkpoint::deserialize(checkpointImage, store, bodies, engine, false, error)) {
+        cout << "Could not load checkpoint: " << error << endl;
+        return;
+    }
+
+    scheduler.reset();
+    resetCount++;
+
+    history.clear();
+    history.addKeyframe(stepCount, store, bodies, engine, false);
+
+    cout << "Checkpoint loaded, continuing from " << engine.getClock().now() << "s" << endl;
+}
+
+// Step 'seconds' of simulated time before the newest one, clamped to the history that is kept
+long long PhysicsThread::stepsBack(float seconds) const {
+    long long steps = llround(seconds / scheduler.getStepDelta());
+    return max(history.getOldestStep(), history.getNewestStep() - steps);
+}
+
+void PhysicsThread::rewind(long long step) {
+    scrubStep = -1;
+
+    PhysicsSettings settings = engine.getSettings();
+    if (!history.rewind(step, store, bodies, engine, static_cast<float>(scheduler.getStepDelta()))) return;
+
+    stepCount = step;
+    scheduler.reset();
+    resetCount++;
+
+    double now = engine.getClock().now();
+    cout << "Rewound to " << now << "s" << endl;
+    reportRestoredSettings(settings);
+}
+
+void PhysicsThread::undo() {
+    scrubStep = -1;
+
+    PhysicsSettings settings = engine.getSettings();
+    long long step = history.undo(store, bodies, engine, static_cast<float>(scheduler.getStepDelta()));
+    if (step < 0) {
+        cout << "Nothing to undo" << endl;
+        return;
+    }
+
+    stepCount = step;
+    scheduler.reset();
+    resetCount++;
+
+    double now = engine.getClock().now();
+    cout << "Undone, back to " << now << "s" << endl;
+    reportRestoredSettings(settings);
+}
+
+// Keyframes hold the settings they were stepped with, going back past a settings change restores the old ones.
+// The next snapshot carries them to the render thread
+void PhysicsThread::reportRestoredSettings(const PhysicsSettings& before) const {
+    if (engine.getSettings() == before) return;
+    cout << "Physics settings went back to those in use at " << engine.getClock().now() << "s" << endl;
+}
+
+void PhysicsThread::publish() {
+    ProfileScope profile("Publish snapshot");
+
+    SimulationSnapshot& snapshot = snapshots.writeBuffer();
+    int count = static_cast<int>(bodies.size());
+
+    snapshot.bodies.resize(count);
+    for (int i = 0; i < count; i++) {
+        const CelestialBody* body = bodies[i];
+        BodySnapshot& out = snapshot.bodies[i];
+
+        out.position = body->getPosition();
+        out.previousPosition = body->previousPosition;
+
+        // A scrub shows the past positions from the history, everything else stays as it is now
+        if (scrubStep >= 0 && scrubPositions.size() == bodies.size()) {
+            out.position = scrubPositions[i];
+            out.previousPosition = scrubPositions[i];
+        }
+        out.velocity = body->getVelocity();
+        out.radius = body->getRadius();
+        out.color = body->color;
+        out.rotationAngle = body->rotationAngle;
+        out.isInShadow = body->isInShadow;
+        out.shadowIntensity = body->shadowIntensity;
+        out.shadowDirection = body->shadowDirection;
+    }
+
+    snapshot.stepCount = stepCount;
+    snapshot.resetCount = resetCount;
+    snapshot.simulationTime = engine.getClock().now();
+    snapshot.interpolation = scheduler.getInterpolation();
+    snapshot.publishTime = steadySeconds();
+    snapshot.timeScale = timeScale;
+    snapshot.stepDelta = static_cast<float>(scheduler.getStepDelta());
+    snapshot.settings = engine.getSettings();
+
+    snapshots.publish();
+}
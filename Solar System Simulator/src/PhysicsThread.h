@@ -0,0 +1,80 @@
+#ifndef PHYSICSTHREAD_H
+#define PHYSICSTHREAD_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "BodyStore.h"
+#include "CelestialBody.h"
+#include "PhysicsEngine.h"
+#include "FixedStepScheduler.h"
+#include "TripleBuffer.h"
+#include "SimulationSnapshot.h"
+#include "SimulationCommand.h"
+#include "SpscQueue.h"
+#include "Checkpoint.h"
+#include "RewindBuffer.h"
+
+using namespace std;
+
+// Runs the fixed-step physics on its own thread. The renderer reads snapshots and sends commands,
+// neither of which takes a lock or waits on the physics
+class PhysicsThread {
+public:
+    PhysicsThread(PhysicsEngine& engine, BodyStore& store, vector<CelestialBody*>& bodies, FixedStepScheduler& scheduler);
+    ~PhysicsThread();
+
+    void start();
+    void stop();
+
+    // File used by the checkpoint commands, set before start
+    void setCheckpointPath(const string& path);
+
+    // Input side: queues a command for the next step boundary, false if the queue is full
+    bool submit(const SimulationCommand& command);
+
+    // Reader side: newest snapshot, 'changed' is set when it differs from the last call
+    const SimulationSnapshot& readSnapshot(bool& changed);
+
+    // Interpolation for drawing a snapshot at the current time
+    static float getRenderInterpolation(const SimulationSnapshot& snapshot);
+
+private:
+    PhysicsEngine& engine;
+    BodyStore& store;
+    vector<CelestialBody*>& bodies;
+    FixedStepScheduler& scheduler;
+
+    thread worker;
+    atomic<bool> stopping;
+
+    // Owned by the physics thread once started
+    float timeScale;
+    long long stepCount;
+    int resetCount;
+    BodyStore initialState; // What a reset goes back to
+
+    RewindBuffer history;
+    long long scrubStep; // Step shown while scrubbing, -1 when not
+    vector<glm::vec3> scrubPositions;
+
+    string checkpointPath;
+    CheckpointWriter checkpointWriter;
+    vector<char> checkpointImage;
+
+    TripleBuffer<SimulationSnapshot> snapshots;
+    SpscQueue<SimulationCommand, 256> commands;
+
+    void run();
+    bool applyCommands();
+    void applyCommand(const SimulationCommand& command);
+    void reset();
+    void loadCheckpoint();
+    long long stepsBack(float seconds) const;
+    void rewind(long long step);
+    void undo();
+    void reportRestoredSettings(const PhysicsSettings& before) const;
+    void publish();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+// Compile time precision policy of the physics state. Define PHYSICS_PRECISION in every project that includes
+// the simulation (SimulationCore and everything linking it), the headers have to agree
+#define PRECISION_FLOAT 0 // Positions and velocities in float, the fastest and what the renderer uses anyway
+#define PRECISION_MIXED 1 // Positions and velocities in double, forces still evaluated in float from a copy
+
+#ifndef PHYSICS_PRECISION
+#define PHYSICS_PRECISION PRECISION_FLOAT
+#endif
+
+#if PHYSICS_PRECISION == PRECISION_MIXED
+// Small per-step changes to large positions and velocities no longer round away, which is
+// where long runs lose their orbits. Forces only need relative accuracy, so they stay in float and SIMD
+typedef double PhysicsReal;
+#elif PHYSICS_PRECISION == PRECISION_FLOAT
+typedef float PhysicsReal;
+#else
+#error "Unknown PHYSICS_PRECISION"
+#endif
+
+inline const char* getPrecisionName() {
+#if PHYSICS_PRECISION == PRECISION_MIXED
+    return "mixed (double state, float forces)";
+#else
+    return "float";
+#endif
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "Profiler.h"
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+// Written by its thread only. Fields are relaxed atomics so a concurrent export reads them without a data race,
+// events it might have caught half overwritten are dropped by checking the head again afterwards
+struct ProfileEvent {
+    atomic<const char*> name;
+    atomic<int64_t> start;
+    atomic<int64_t> end;
+};
+
+struct ThreadEvents {
+    int id;
+    atomic<const char*> name;
+    atomic<uint64_t> head; // Events written so far
+    ProfileEvent events[PROFILER_EVENTS_PER_THREAD];
+
+    ThreadEvents(int threadId) : id(threadId), name(nullptr), head(0) {}
+};
+
+atomic<bool> Profiler::enabled(false);
+
+// Rings are kept after their thread ends so its events still get exported
+static mutex registryMutex;
+static vector<unique_ptr<ThreadEvents>> registry;
+static thread_local ThreadEvents* threadEvents = nullptr;
+
+// Only taken once per thread, the first time it records
+static ThreadEvents* currentThreadEvents() {
+    if (!threadEvents) {
+        lock_guard<mutex> lock(registryMutex);
+        registry.push_back(make_unique<ThreadEvents>(static_cast<int>(registry.size()) + 1));
+        threadEvents = registry.back().get();
+    }
+    return threadEvents;
+}
+
+void Profiler::setEnabled(bool on) {
+    enabled.store(on, memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return enabled.load(memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const char* name) {
+    currentThreadEvents()->name.store(name, memory_order_relaxed);
+}
+
+int64_t Profiler::now() {
+    static const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+}
+
+void Profiler::record(const char* name, int64_t startNs, int64_t endNs) {
+    ThreadEvents* events = currentThreadEvents();
+    uint64_t head = events->head.load(memory_order_relaxed);
+
+    // The slot is written after the head that marks it as being overwritten, an export checks against that head
+    atomic_thread_fence(memory_order_release);
+
+    ProfileEvent& event = events->events[head % PROFILER_EVENTS_PER_THREAD];
+    event.name.store(name, memory_order_relaxed);
+    event.start.store(startNs, memory_order_relaxed);
+    event.end.store(endNs, memory_order_relaxed);
+
+    events->head.store(head + 1, memory_order_release);
+}
+
+bool Profiler::exportChromeTrace(const string& path) {
+    ofstream file(path);
+    if (!file) return false;
+
+    vector<ThreadEvents*> threads;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        for (auto& events : registry) threads.push_back(events.get());
+    }
+
+    // Microseconds to the nanosecond, long runs would otherwise lose it to scientific notation
+    file << fixed << setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+    bool first = true;
+    size_t exported = 0;
+
+    for (ThreadEvents* thread : threads) {
+        const char* threadName = thread->name.load(memory_order_relaxed);
+        if (threadName) {
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+                 << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+            first = false;
+        }
+
+        uint64_t head = thread->head.load(memory_order_acquire);
+        uint64_t oldest = head > PROFILER_EVENTS_PER_THREAD ? head - PROFILER_EVENTS_PER_THREAD : 0;
+
+        vector<pair<const char*, pair<int64_t, int64_t>>> copied;
+        for (uint64_t i = oldest; i < head; i++) {
+            const ProfileEvent& event = thread->events[i % PROFILER_EVENTS_PER_THREAD];
+            copied.push_back({ event.name.load(memory_order_relaxed),
+                               { event.start.load(memory_order_relaxed), event.end.load(memory_order_relaxed) } });
+        }
+
+        // Slots the thread wrote to while they were copied may mix two events, that includes the one it may be writing now
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t headAfter = thread->head.load(memory_order_relaxed) + 1;
+        uint64_t firstIntact = headAfter > PROFILER_EVENTS_PER_THREAD ? headAfter - PROFILER_EVENTS_PER_THREAD : 0;
+
+        for (uint64_t i = max(oldest, firstIntact); i < head; i++) {
+            const auto& event = copied[i - oldest];
+            // Complete events, Chrome wants microseconds
+            file << (first ? "" : ",\n") << "{\"name\":\"" << event.first << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+                 << ",\"ts\":" << event.second.first / 1000.0 << ",\"dur\":" << (event.second.second - event.second.first) / 1000.0 << "}";
+            first = false;
+            exported++;
+        }
+    }
+
+    file << endl << "]}" << endl;
+    cout << "Exported " << exported << " profiler events to " << path << endl;
+    return true;
+}
+
+ProfileScope::ProfileScope(const char* name) : name(name), start(Profiler::isEnabled() ? Profiler::now() : -1) {}
+
+ProfileScope::~ProfileScope() {
+    end();
+}
+
+void ProfileScope::end() {
+    if (start >= 0) Profiler::record(name, start, Profiler::now());
+    start = -1;
+}
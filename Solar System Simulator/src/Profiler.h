@@ -0,0 +1,50 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+const int PROFILER_EVENTS_PER_THREAD = 65536; // Ring size, older events are overwritten
+
+// Timeline of named phases on every thread, for finding where a slow frame went.
+// Always compiled in and off by default; while off a scope costs one relaxed load.
+// Each thread writes its own ring buffer without locks, export can run while the threads keep recording
+class Profiler {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // Shown as the thread's name in the trace, call from the thread itself
+    static void setThreadName(const char* name);
+
+    // 'name' has to stay valid until the export, string literals do
+    static void record(const char* name, int64_t startNs, int64_t endNs);
+
+    // Nanoseconds since the profiler was first used
+    static int64_t now();
+
+    // Every event still in the rings as Chrome trace JSON, for chrome://tracing or Perfetto
+    static bool exportChromeTrace(const string& path);
+
+private:
+    static atomic<bool> enabled;
+};
+
+// Times the enclosing block when the profiler is on
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+
+    // Ends the phase before the block does
+    void end();
+
+private:
+    const char* name;
+    int64_t start; // -1 if the profiler was off when the scope started
+};
+
+#endif
\ No newline at end of file
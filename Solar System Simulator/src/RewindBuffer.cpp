@@ -0,0 +1,212 @@
+#include "RewindBuffer.h"
+#include "Checkpoint.h"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+// Small deltas of either sign become small unsigned numbers, written 7 bits per byte
+static void writeVarint(vector<uint8_t>& out, int64_t value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        out.push_back(static_cast<uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(zigzag));
+}
+
+static int64_t readVarint(const uint8_t*& in) {
+    uint64_t zigzag = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        zigzag |= static_cast<uint64_t>(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    zigzag |= static_cast<uint64_t>(*in++) << shift;
+    return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+}
+
+long long RewindBuffer::Segment::getNewestStep() const {
+    return step + static_cast<long long>(stepOffsets.size());
+}
+
+size_t RewindBuffer::Segment::getMemoryUsed() const {
+    return keyframe.size() + (base.size() + last.size()) * sizeof(int64_t) + deltas.size() + stepOffsets.size() * sizeof(uint32_t);
+}
+
+RewindBuffer::RewindBuffer(size_t memoryBudget, int keyframeInterval)
+    : memoryBudget(memoryBudget), memoryUsed(0), keyframeInterval(keyframeInterval) {}
+
+void RewindBuffer::setMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+    enforceBudget();
+}
+
+size_t RewindBuffer::getMemoryUsed() const {
+    return memoryUsed;
+}
+
+void RewindBuffer::clear() {
+    segments.clear();
+    memoryUsed = 0;
+}
+
+bool RewindBuffer::isEmpty() const {
+    return segments.empty();
+}
+
+long long RewindBuffer::getOldestStep() const {
+    return segments.empty() ? -1 : segments.front().step;
+}
+
+long long RewindBuffer::getNewestStep() const {
+    return segments.empty() ? -1 : segments.back().getNewestStep();
+}
+
+void RewindBuffer::quantize(const BodyStore& store, vector<int64_t>& quantized) {
+    int count = store.size();
+    quantized.resize(count * 3);
+
+    for (int i = 0; i < count; i++) {
+        quantized[i * 3 + 0] = llround(store.x[i] / REWIND_POSITION_QUANTUM);
+        quantized[i * 3 + 1] = llround(store.y[i] / REWIND_POSITION_QUANTUM);
+        quantized[i * 3 + 2] = llround(store.z[i] / REWIND_POSITION_QUANTUM);
+    }
+}
+
+void RewindBuffer::addKeyframe(long long step, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine,
+                               bool afterCommand) {
+    segments.emplace_back();
+    Segment& segment = segments.back();
+
+    segment.step = step;
+    segment.afterCommand = afterCommand;
+    Checkpoint::serialize(store, bodies, engine, false, segment.keyframe);
+    quantize(store, segment.base);
+    segment.last = segment.base;
+
+    memoryUsed += segment.getMemoryUsed();
+    enforceBudget();
+}
+
+void RewindBuffer::recordStep(long long step, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine) {
+    // A keyframe is due, or the step doesn't follow on from the history
+    if (segments.empty() || step != segments.back().getNewestStep() + 1 || step - segments.back().step >= keyframeInterval ||
+        segments.back().last.size() != static_cast<size_t>(store.size()) * 3) {
+        addKeyframe(step, store, bodies, engine, false);
+        return;
+    }
+
+    Segment& segment = segments.back();
+    size_t before = segment.getMemoryUsed();
+
+    vector<int64_t> quantized;
+    quantize(store, quantized);
+
+    segment.stepOffsets.push_back(static_cast<uint32_t>(segment.deltas.size()));
+    for (size_t k = 0; k < quantized.size(); k++) {
+        writeVarint(segment.deltas, quantized[k] - segment.last[k]);
+    }
+    segment.last.swap(quantized);
+
+    memoryUsed += segment.getMemoryUsed() - before;
+    enforceBudget();
+}
+
+// Newest segment holding 'step', -1 if it is outside the history
+int RewindBuffer::findSegment(long long step) const {
+    for (int i = static_cast<int>(segments.size()) - 1; i >= 0; i--) {
+        if (segments[i].step <= step && step <= segments[i].getNewestStep()) return i;
+    }
+    return -1;
+}
+
+bool RewindBuffer::decodePositions(long long step, vector<glm::vec3>& positions) const {
+    int index = findSegment(step);
+    if (index < 0) return false;
+
+    const Segment& segment = segments[index];
+    vector<int64_t> quantized = segment.base;
+
+    // Every delta from the keyframe up to the step, at most one keyframe interval of them
+    const uint8_t* in = segment.deltas.data();
+    for (long long s = segment.step; s < step; s++) {
+        for (size_t k = 0; k < quantized.size(); k++) {
+            quantized[k] += readVarint(in);
+        }
+    }
+
+    positions.resize(quantized.size() / 3);
+    for (size_t i = 0; i < positions.size(); i++) {
+        positions[i] = glm::vec3(quantized[i * 3], quantized[i * 3 + 1], quantized[i * 3 + 2]) * REWIND_POSITION_QUANTUM;
+    }
+    return true;
+}
+
+// Drops every step after 'step', which has to be in 'segment'
+void RewindBuffer::truncate(int segment, long long step) {
+    while (static_cast<int>(segments.size()) > segment + 1) {
+        memoryUsed -= segments.back().getMemoryUsed();
+        segments.pop_back();
+    }
+
+    Segment& kept = segments[segment];
+    size_t before = kept.getMemoryUsed();
+
+    size_t steps = static_cast<size_t>(step - kept.step);
+    if (steps < kept.stepOffsets.size()) {
+        kept.deltas.resize(kept.stepOffsets[steps]);
+        kept.stepOffsets.resize(steps);
+    }
+
+    memoryUsed -= before - kept.getMemoryUsed();
+}
+
+bool RewindBuffer::restore(int segment, long long step, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine,
+                           float stepDelta) {
+    string error;
+    if (!Checkpoint::deserialize(segments[segment].keyframe, store, bodies, engine, false, error)) {
+        cout << "Could not rewind: " << error << endl;
+        return false;
+    }
+
+    // Nothing changed the state between the keyframe and the step, so stepping again ends up exactly where it was
+    for (long long s = segments[segment].step; s < step; s++) {
+        for (auto& body : bodies) {
+            body->storePreviousPosition();
+        }
+        engine.updatePhysics(store, bodies, stepDelta);
+    }
+
+    truncate(segment, step);
+    quantize(store, segments[segment].last);
+    return true;
+}
+
+bool RewindBuffer::rewind(long long step, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine, float stepDelta) {
+    if (segments.empty()) return false;
+
+    step = max(getOldestStep(), min(step, getNewestStep()));
+    return restore(findSegment(step), step, store, bodies, engine, stepDelta);
+}
+
+long long RewindBuffer::undo(BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine, float stepDelta) {
+    for (int i = static_cast<int>(segments.size()) - 1; i > 0; i--) {
+        if (!segments[i].afterCommand) continue;
+
+        // The segment before ends at the step the command came in, before it was applied
+        long long step = segments[i].step;
+        if (segments[i - 1].getNewestStep() != step) return -1;
+
+        return restore(i - 1, step, store, bodies, engine, stepDelta) ? step : -1;
+    }
+    return -1;
+}
+
+void RewindBuffer::enforceBudget() {
+    // The newest keyframe always stays, whatever the budget
+    while (memoryUsed > memoryBudget && segments.size() > 1) {
+        memoryUsed -= segments.front().getMemoryUsed();
+        segments.pop_front();
+    }
+}
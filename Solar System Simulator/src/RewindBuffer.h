@@ -0,0 +1,81 @@
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+#include "BodyStore.h"
+#include "CelestialBody.h"
+#include "PhysicsEngine.h"
+
+using namespace std;
+
+const size_t DEFAULT_REWIND_BUDGET = 64 * 1024 * 1024;
+const int DEFAULT_KEYFRAME_INTERVAL = 256;  // Steps between keyframes, also the most a rewind re-integrates
+const float REWIND_POSITION_QUANTUM = 1e-4f; // Position resolution of the deltas, only used for previews
+
+// Recent history of the simulation for undo and time scrubbing. Every few hundred steps the full state is kept
+// as a checkpoint image, in between only the positions are, quantized and stored as varint deltas to the step
+// before, a few bytes per body per step. The oldest history is dropped to stay inside the memory budget.
+// Commands that change the state start a new keyframe, so the steps between two keyframes can always be
+// integrated again exactly from the first one
+class RewindBuffer {
+public:
+    RewindBuffer(size_t memoryBudget = DEFAULT_REWIND_BUDGET, int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryUsed() const;
+
+    void clear();
+
+    // Keeps the full state at 'step'. 'afterCommand' marks a state a command just changed, undo goes back before it
+    void addKeyframe(long long step, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine,
+                     bool afterCommand);
+
+    // Call after every physics step, a keyframe is taken by itself when one is due
+    void recordStep(long long step, const BodyStore& store, const vector<CelestialBody*>& bodies, const PhysicsEngine& engine);
+
+    bool isEmpty() const;
+    long long getOldestStep() const;
+    long long getNewestStep() const;
+
+    // Positions at an earlier step from the deltas, without touching the simulation
+    bool decodePositions(long long step, vector<glm::vec3>& positions) const;
+
+    // Puts the simulation back to 'step' by loading the nearest keyframe before it and stepping forward.
+    // History after the step is dropped
+    bool rewind(long long step, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine, float stepDelta);
+
+    // Back to just before the newest command that changed the state, returns the step or -1 if there is none
+    long long undo(BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine, float stepDelta);
+
+private:
+    // One keyframe and the steps recorded after it
+    struct Segment {
+        long long step;               // Step of the keyframe
+        bool afterCommand;
+        vector<char> keyframe;        // Checkpoint image
+        vector<int64_t> base;         // Quantized keyframe positions, x y z per body
+        vector<int64_t> last;         // Quantized positions of the newest step, what the next deltas are against
+        vector<uint8_t> deltas;       // Varint deltas of every step after the keyframe
+        vector<uint32_t> stepOffsets; // Where each step starts in 'deltas'
+
+        long long getNewestStep() const;
+        size_t getMemoryUsed() const;
+    };
+
+    deque<Segment> segments;
+    size_t memoryBudget;
+    size_t memoryUsed;
+    int keyframeInterval;
+
+    int findSegment(long long step) const;
+    void truncate(int segment, long long step);
+    bool restore(int segment, long long step, BodyStore& store, vector<CelestialBody*>& bodies, PhysicsEngine& engine, float stepDelta);
+    void enforceBudget();
+
+    static void quantize(const BodyStore& store, vector<int64_t>& quantized);
+};
+
+#endif
\ No newline at end of file
@@ -56,6 +56,55 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+
+    reflectUniforms();
+}
+
+// Caches the location and type of every active uniform
+void Shader::reflectUniforms() {
+    uniforms.clear();
+
+    GLint linked = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (!linked) return;
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    vector<GLchar> nameBuffer(max(maxLength, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+        string name(nameBuffer.data(), length);
+        GLint location = glGetUniformLocation(ID, name.c_str());
+
+        // Uniform block members have no location
+        if (location < 0) continue;
+
+        uniforms[name] = Uniform(location, type);
+
+        // Arrays are reported as "name[0]", also accept the plain name
+        size_t bracket = name.find('[');
+        if (bracket != string::npos) {
+            uniforms[name.substr(0, bracket)] = Uniform(location, type);
+        }
+    }
+}
+
+Uniform Shader::getUniform(const string& name) const {
+    auto it = uniforms.find(name);
+    if (it == uniforms.end()) return Uniform();
+    return it->second;
+}
+
+GLint Shader::uniformLocation(const string& name) const {
+    auto it = uniforms.find(name);
+    return it != uniforms.end() ? it->second.location : -1;
 }
 
 void Shader::use() {
@@ -63,27 +112,55 @@ void Shader::use() {
 }
 
 void Shader::setBool(const string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(uniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const string& name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(uniformLocation(name), value);
 }
 
 void Shader::setFloat(const string& name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(uniformLocation(name), value);
 }
 
 void Shader::setVec3(const string& name, const glm::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(uniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec3(const string& name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(uniformLocation(name), x, y, z);
 }
 
 void Shader::setMat4(const string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setBool(Uniform uniform, bool value) const {
+    glUniform1i(uniform.location, (int)value);
+}
+
+void Shader::setInt(Uniform uniform, int value) const {
+    glUniform1i(uniform.location, value);
+}
+
+void Shader::setFloat(Uniform uniform, float value) const {
+    glUniform1f(uniform.location, value);
+}
+
+void Shader::setVec3(Uniform uniform, const glm::vec3& value) const {
+    glUniform3fv(uniform.location, 1, &value[0]);
+}
+
+void Shader::setMat4(Uniform uniform, const glm::mat4& mat) const {
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+}
+
+bool Shader::bindUniformBlock(const string& blockName, GLuint binding) const {
+    GLuint blockIndex = glGetUniformBlockIndex(ID, blockName.c_str());
+    if (blockIndex == GL_INVALID_INDEX) return false;
+
+    glUniformBlockBinding(ID, blockIndex, binding);
+    return true;
 }
 
 void Shader::checkCompileErrors(GLuint shader, string type) {
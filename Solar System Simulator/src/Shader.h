@@ -7,9 +7,22 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
+// Uniform location resolved once after linking, -1 if the program has no such active uniform
+struct Uniform {
+    GLint location;
+    GLenum type;
+
+    Uniform() : location(-1), type(0) {}
+    Uniform(GLint location, GLenum type) : location(location), type(type) {}
+
+    bool isActive() const { return location >= 0; }
+};
+
 class Shader {
 public:
     Shader(const char* vertexPath, const char* fragmentPath);
@@ -21,9 +34,27 @@ public:
     void setVec3(const string& name, float x, float y, float z) const;
     void setMat4(const string& name, const glm::mat4& mat) const;
 
+    // Handle lookup, done once at load time
+    Uniform getUniform(const string& name) const;
+
+    // Per-frame uploads through pre-resolved handles
+    void setBool(Uniform uniform, bool value) const;
+    void setInt(Uniform uniform, int value) const;
+    void setFloat(Uniform uniform, float value) const;
+    void setVec3(Uniform uniform, const glm::vec3& value) const;
+    void setMat4(Uniform uniform, const glm::mat4& mat) const;
+
+    // Assigns a uniform block to a binding point, false if the program has no such block
+    bool bindUniformBlock(const string& blockName, GLuint binding) const;
+
+    GLuint getID() const { return ID; }
+
 private:
     GLuint ID;
+    unordered_map<string, Uniform> uniforms; // Active uniforms by name
 
+    void reflectUniforms();
+    GLint uniformLocation(const string& name) const;
     void checkCompileErrors(GLuint shader, string type);
 };
 
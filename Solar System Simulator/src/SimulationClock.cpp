@@ -0,0 +1,15 @@
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock() : time(0.0) {}
+
+void SimulationClock::advance(double deltaTime) {
+    time += deltaTime;
+}
+
+void SimulationClock::reset(double startTime) {
+    time = startTime;
+}
+
+double SimulationClock::now() const {
+    return time;
+}
@@ -0,0 +1,18 @@
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+// Simulated time in seconds, advanced by the physics instead of read from the window system,
+// so runs give the same results with or without a window and at any speed
+class SimulationClock {
+public:
+    SimulationClock();
+
+    void advance(double deltaTime);
+    void reset(double startTime = 0.0);
+    double now() const;
+
+private:
+    double time;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef SIMULATIONCOMMAND_H
+#define SIMULATIONCOMMAND_H
+
+#include <glm/glm.hpp>
+#include "PhysicsSettings.h"
+
+enum CommandType {
+    COMMAND_APPLY_IMPULSE = 0,  // Adds 'vector' to the body's velocity
+    COMMAND_STOP_BODY = 1,      // Sets the body's velocity to zero
+    COMMAND_RESET = 2,          // Back to the state the simulation started from
+    COMMAND_SET_TIME_SCALE = 3, // 'value' simulated seconds per real second, 0 pauses
+    COMMAND_SET_PHYSICS = 4,    // Replaces the engine settings with 'settings'
+    COMMAND_SAVE_CHECKPOINT = 5,// Writes the state to the checkpoint path in the background
+    COMMAND_LOAD_CHECKPOINT = 6,// Continues from the checkpoint file
+    COMMAND_SCRUB = 7,          // Shows the state 'value' seconds before the newest step, the simulation waits meanwhile
+    COMMAND_REWIND = 8,         // Continues from 'value' seconds before the newest step
+    COMMAND_UNDO = 9            // Back to just before the last impulse or stop
+};
+
+// Request from the input thread, applied by the physics thread between two steps
+struct SimulationCommand {
+    CommandType type;
+    int bodyId;             // Stable store ID of the target body
+    glm::vec3 vector;
+    float value;
+    PhysicsSettings settings;
+
+    SimulationCommand();
+};
+
+#endif
\ No newline at end of file
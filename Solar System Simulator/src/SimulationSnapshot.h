@@ -0,0 +1,38 @@
+#ifndef SIMULATIONSNAPSHOT_H
+#define SIMULATIONSNAPSHOT_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "PhysicsSettings.h"
+
+using namespace std;
+
+// What the renderer needs of one body, copied out after the physics steps
+struct BodySnapshot {
+    glm::vec3 position;
+    glm::vec3 previousPosition; // Before the last step, for interpolation
+    glm::vec3 velocity;
+    float radius;
+    glm::vec3 color;
+    float rotationAngle;
+    bool isInShadow;
+    float shadowIntensity;
+    glm::vec3 shadowDirection;
+};
+
+// Immutable state published by the physics thread, index i belongs to bodies[i]
+struct SimulationSnapshot {
+    vector<BodySnapshot> bodies;
+    long long stepCount;    // Physics steps taken when the snapshot was made
+    int resetCount;         // Changes whenever the simulation was reset
+    double simulationTime;
+    float interpolation;    // Scheduler interpolation when published
+    double publishTime;     // Seconds on the steady clock
+    float timeScale;
+    float stepDelta;
+    PhysicsSettings settings; // Engine settings the state was stepped with
+
+    SimulationSnapshot();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "SolarSystemScene.h"
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+// Sun, planets and the Moon of the default scene, replacing any bodies already in the list
+void buildSolarSystem(BodyStore& bodyStore, vector<CelestialBody*>& celestialBodies) {
+    float G = 0.01f; // Gravity strength
+
+    for (auto body : celestialBodies) {
+        delete body;
+    }
+    celestialBodies.clear();
+    bodyStore.clear();
+
+    // Sun
+    CelestialBody* sun = new CelestialBody(
+        bodyStore,
+        glm::vec3(0.0f, 0.0f, 0.0f), // Initial position
+        glm::vec3(0.0f, 0.0f, 0.0f), // Orbital velocity
+        10000.0f, // Mass
+        3.0f, // Radius
+        glm::vec3(1.0f, 0.8f, 0.2f), // Under texture color
+        "Sun", // Name
+        BODY_STATIC | BODY_STAR // Static 'planet' that lights the scene
+    );
+    celestialBodies.push_back(sun);
+
+    // Mercury
+    glm::vec3 mercuryPos = glm::vec3(11.0f, 0.0f, 0.0f); // Initial position
+    float mercuryDistance = glm::length(mercuryPos); // Distance from Sun   
+    float mercurySpeed = sqrt(G * sun->getMass() / mercuryDistance); // Orbital speed using Newton's gravity formula
+    glm::vec3 mercuryDir = glm::normalize(glm::cross(mercuryPos, glm::vec3(0.0f, 1.0f, 0.0f))); // Orbital direction
+    glm::vec3 mercuryVel = mercuryDir * mercurySpeed; // Orbital velocity
+
+    CelestialBody* mercury = new CelestialBody(
+        bodyStore,
+        mercuryPos,
+        mercuryVel,
+        0.2f,
+        0.4f,
+        glm::vec3(0.8f, 0.7f, 0.6f),
+        "Mercury"
+    );
+    mercury->rotationSpeed = 15.0f; // Rotation speed 
+    celestialBodies.push_back(mercury);
+
+    // Venus
+    glm::vec3 venusPos = glm::vec3(18.0f, 0.0f, 1.0f);
+    float venusDistance = glm::length(venusPos);
+    float venusSpeed = sqrt(G * sun->getMass() / venusDistance);
+    glm::vec3 venusDir = glm::normalize(glm::cross(venusPos, glm::vec3(0.0f, -1.0f, 0.0f))); // Venus rotates backwords
+    glm::vec3 venusVel = venusDir * venusSpeed;
+
+    CelestialBody* venus = new CelestialBody(
+        bodyStore,
+        venusPos,
+        venusVel,
+        0.5f,
+        0.7f,
+        glm::vec3(1.0f, 0.8f, 0.4f),
+        "Venus"
+    );
+    venus->rotationSpeed = 10.0f;
+    celestialBodies.push_back(venus);
+
+    // Earth
+    glm::vec3 earthPos = glm::vec3(25.0f, 0.0f, 0.0f);
+    float earthDistance = glm::length(earthPos);
+    float earthSpeed = sqrt(G * sun->getMass() / earthDistance);
+    glm::vec3 earthDir = glm::normalize(glm::cross(earthPos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 earthVel = earthDir * earthSpeed;
+
+    CelestialBody* earth = new CelestialBody(
+        bodyStore,
+        earthPos,
+        earthVel,
+        2.0f,
+        0.8f,
+        glm::vec3(0.2f, 0.4f, 1.0f),
+        "Earth"
+    );
+    earth->rotationSpeed = 20.0f;
+    celestialBodies.push_back(earth);
+
+    // Mars
+    glm::vec3 marsPos = glm::vec3(35.0f, 0.0f, 3.0f);
+    float marsDistance = glm::length(marsPos);
+    float marsSpeed = sqrt(G * sun->getMass() / marsDistance);
+    glm::vec3 marsDir = glm::normalize(glm::cross(marsPos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 marsVel = marsDir * marsSpeed;
+
+    CelestialBody* mars = new CelestialBody(
+        bodyStore,
+        marsPos,
+        marsVel,
+        1.2f,
+        0.6f,
+        glm::vec3(1.0f, 0.3f, 0.2f),
+        "Mars"
+    );
+    mars->rotationSpeed = 20.0f;
+    celestialBodies.push_back(mars);
+
+    // Jupiter
+    glm::vec3 jupiterPos = glm::vec3(50.0f, 0.0f, -5.0f);
+    float jupiterDistance = glm::length(jupiterPos);
+    float jupiterSpeed = sqrt(G * sun->getMass() / jupiterDistance);
+    glm::vec3 jupiterDir = glm::normalize(glm::cross(jupiterPos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 jupiterVel = jupiterDir * jupiterSpeed;
+
+    CelestialBody* jupiter = new CelestialBody(
+        bodyStore,
+        jupiterPos,
+        jupiterVel,
+        7.0f,
+        2.0f,
+        glm::vec3(0.8f, 0.6f, 0.4f),
+        "Jupiter"
+    );
+    jupiter->rotationSpeed = 40.0f; // Fast rotation
+    celestialBodies.push_back(jupiter);
+
+    // Saturn
+    glm::vec3 saturnPos = glm::vec3(70.0f, 0.0f, 4.0f);
+    float saturnDistance = glm::length(saturnPos);
+    float saturnSpeed = sqrt(G * sun->getMass() / saturnDistance);
+    glm::vec3 saturnDir = glm::normalize(glm::cross(saturnPos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 saturnVel = saturnDir * saturnSpeed;
+
+    CelestialBody* saturn = new CelestialBody(
+        bodyStore,
+        saturnPos,
+        saturnVel,
+        6.0f,
+        1.5f,
+        glm::vec3(0.9f, 0.8f, 0.6f),
+        "Saturn"
+    );
+    saturn->rotationSpeed = 35.0f;
+    saturn->hasRings = true;
+    saturn->ringInnerRadius = 1.0f;  // 1.0 times Saturn's radius
+    saturn->ringOuterRadius = 2.0f;  // 2.0 times Saturn's radius
+    celestialBodies.push_back(saturn);
+
+    // Uranus
+    glm::vec3 uranusPos = glm::vec3(100.0f, 0.0f, -3.0f);
+    float uranusDistance = glm::length(uranusPos);
+    float uranusSpeed = sqrt(G * sun->getMass() / uranusDistance);
+    glm::vec3 uranusDir = glm::normalize(glm::cross(uranusPos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 uranusVel = uranusDir * uranusSpeed;
+
+    CelestialBody* uranus = new CelestialBody(
+        bodyStore,
+        uranusPos,
+        uranusVel,
+        4.0f,
+        1.0f,
+        glm::vec3(0.6f, 0.8f, 0.9f),
+        "Uranus"
+    );
+    uranus->rotationSpeed = 30.0f;
+    uranus->rotationAxis = glm::vec3(0.0f, 0.0f, 1.0f); // Uranus rotates on its side
+    celestialBodies.push_back(uranus);
+
+    // Neptune
+    glm::vec3 neptunePos = glm::vec3(120.0f, 0.0f, 2.0f);
+    float neptuneDistance = glm::length(neptunePos);
+    float neptuneSpeed = sqrt(G * sun->getMass() / neptuneDistance);
+    glm::vec3 neptuneDir = glm::normalize(glm::cross(neptunePos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 neptuneVel = neptuneDir * neptuneSpeed;
+
+    CelestialBody* neptune = new CelestialBody(
+        bodyStore,
+        neptunePos,
+        neptuneVel,
+        5.0f,
+        1.2f,
+        glm::vec3(0.2f, 0.4f, 0.8f),
+        "Neptune"
+    );
+    neptune->rotationSpeed = 25.0f;
+    celestialBodies.push_back(neptune);
+
+    // Moon (orbiting Earth)
+    glm::vec3 moonPos = earth->getPosition() + glm::vec3(0.0f, 0.0f, 2.0f);
+    glm::vec3 moonVel = earth->getVelocity();
+
+    CelestialBody* moon = new CelestialBody(
+        bodyStore,
+        moonPos,
+        moonVel,
+        0.2f,
+        0.3f,
+        glm::vec3(0.7f, 0.7f, 0.7f),
+        "Moon",
+        BODY_MOON,
+        earth
+    );
+    moon->rotationSpeed = 5.0f; // Slow rotation
+    celestialBodies.push_back(moon);
+}
+
+const char* getSceneName(ProceduralScene scene) {
+    switch (scene) {
+    case SCENE_DISK: return "disk";
+    case SCENE_BELT: return "belt";
+    case SCENE_CLUSTER: return "cluster";
+    default: return "unknown";
+    }
+}
+
+// Uniform point inside the unit ball, away from its centre so it can be normalized
+static glm::vec3 randomInBall(mt19937& random) {
+    uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+    glm::vec3 point;
+    do {
+        point = glm::vec3(signedUnit(random), signedUnit(random), signedUnit(random));
+    } while (glm::length(point) > 1.0f || glm::length(point) < 0.01f);
+    return point;
+}
+
+// 'count' bodies in total, the star included
+void buildProceduralScene(BodyStore& bodyStore, vector<CelestialBody*>& celestialBodies, ProceduralScene scene, int count,
+                          unsigned int seed) {
+    float G = 0.01f; // Same gravity strength as the engine
+    float starMass = 10000.0f;
+
+    for (auto body : celestialBodies) {
+        delete body;
+    }
+    celestialBodies.clear();
+    bodyStore.clear();
+
+    bodyStore.reserve(count);
+    celestialBodies.reserve(count);
+
+    mt19937 random(seed);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float pi = 3.14159265f;
+
+    if (scene != SCENE_CLUSTER) {
+        CelestialBody* star = new CelestialBody(bodyStore, glm::vec3(0.0f), glm::vec3(0.0f), starMass, 3.0f,
+                                                glm::vec3(1.0f, 0.8f, 0.2f), "Star", BODY_STATIC | BODY_STAR);
+        celestialBodies.push_back(star);
+    }
+
+    // The cluster is held together by its own mass, spread over its bodies
+    float clusterRadius = 40.0f;
+    float bodyMass = scene == SCENE_CLUSTER ? starMass / max(count, 1) : 0.001f;
+
+    // Bodies shrink as the count grows, so the collision broad phase finds about as many overlaps at any size
+    float bodyRadius = 0.02f * min(1.0f, 10000.0f / max(count, 1));
+
+    while (static_cast<int>(celestialBodies.size()) < count) {
+        glm::vec3 position, velocity;
+        float angle = 2.0f * pi * unit(random);
+
+        if (scene == SCENE_CLUSTER) {
+            // Uniform in a ball, random directions at about the speed that keeps it bound
+            position = randomInBall(random) * clusterRadius;
+            glm::vec3 heading = glm::normalize(randomInBall(random));
+            velocity = heading * 0.5f * sqrt(G * starMass / clusterRadius) * unit(random);
+        }
+        else {
+            // Disk from 8 to 150, belt from 40 to 46 with up to 5 degrees of inclination
+            float inner = scene == SCENE_DISK ? 8.0f : 40.0f;
+            float outer = scene == SCENE_DISK ? 150.0f : 46.0f;
+            float distance = inner + (outer - inner) * unit(random);
+            float height = scene == SCENE_DISK ? 0.5f * (unit(random) - 0.5f) : 0.0f;
+
+            position = glm::vec3(cos(angle) * distance, height, sin(angle) * distance);
+            velocity = glm::normalize(glm::cross(position, glm::vec3(0.0f, 1.0f, 0.0f))) * sqrt(G * starMass / distance);
+
+            if (scene == SCENE_BELT) {
+                float inclination = glm::radians(5.0f) * (unit(random) - 0.5f) * 2.0f;
+                glm::mat4 tilt = glm::rotate(glm::mat4(1.0f), inclination, glm::normalize(position));
+                velocity = glm::vec3(tilt * glm::vec4(velocity, 0.0f));
+            }
+        }
+
+        CelestialBody* body = new CelestialBody(bodyStore, position, velocity, bodyMass, bodyRadius, glm::vec3(0.7f, 0.7f, 0.7f),
+                                                "Body " + to_string(celestialBodies.size()));
+        celestialBodies.push_back(body);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef SOLARSYSTEMSCENE_H
+#define SOLARSYSTEMSCENE_H
+
+#include <vector>
+#include "BodyStore.h"
+#include "CelestialBody.h"
+
+using namespace std;
+
+// Bodies are appended in the order Sun, Mercury ... Neptune, Moon; textures are left to the renderer
+void buildSolarSystem(BodyStore& bodyStore, vector<CelestialBody*>& celestialBodies);
+
+// Generated scenes of any size for benchmarks and stress tests, the same seed gives the same bodies
+enum ProceduralScene {
+    SCENE_DISK = 0,    // Thin disk of bodies on circular orbits around a static star
+    SCENE_BELT = 1,    // Narrow, slightly inclined ring around a static star, most bodies close together
+    SCENE_CLUSTER = 2, // Self-gravitating ball of bodies with no star
+    SCENE_COUNT = 3
+};
+
+const char* getSceneName(ProceduralScene scene);
+
+void buildProceduralScene(BodyStore& bodyStore, vector<CelestialBody*>& celestialBodies, ProceduralScene scene, int count,
+                          unsigned int seed = 1);
+
+#endif
\ No newline at end of file
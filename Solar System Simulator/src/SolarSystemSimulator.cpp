@@ -8,13 +8,23 @@
 #include "Camera.h"
 #include "CelestialBody.h"
 #include "PhysicsEngine.h"
+#include "SolarSystemScene.h"
+#include "FixedStepScheduler.h"
+#include "PhysicsThread.h"
+#include "TrajectoryPlayer.h"
+#include "Profiler.h"
 #include "Model.h"
+#include "FrameUniformBuffer.h"
+#include "BodyRenderer.h"
+#include "OrbitBuffer.h"
 #include "TextureLoader.h"
 
 #include <iostream>
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -24,6 +34,12 @@ enum OrbitMode {
     ORBITS_TRAIL = 2
 };
 
+// Uniform handles of one shader, resolved once after loading
+struct ShaderUniforms {
+    Uniform model;
+    Uniform color, useTexture, textureSampler;
+};
+
 // Function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -31,12 +47,19 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
-void generateFullOrbit(CelestialBody* body, CelestialBody* centralBody, vector<glm::vec3>& orbitPoints);
+int orbitPointCount(CelestialBody* body);
+void generateFullOrbit(CelestialBody* body, CelestialBody* centralBody, const glm::vec3& color, OrbitVertex* orbitPoints);
 void updateCameraToFollowBody(CelestialBody* body);
 void checkManualCameraControl(GLFWwindow* window);
 void createBackground();
 
 void loadTextures();
+void syncWithPhysics();
+void sendCommand(const SimulationCommand& command);
+void sendImpulse(CelestialBody* body, const glm::vec3& impulse);
+void sendPhysicsSettings();
+bool canChangePhysicsSettings();
+ShaderUniforms resolveUniforms(const Shader* shader);
 
 // Settings
 const unsigned int SCR_WIDTH = 1500;
@@ -70,14 +93,40 @@ const float MIN_TIME_SCALE = 0.1f;
 const float MAX_TIME_SCALE = 10.0f;
 const float TIME_SCALE_STEP = 0.5f;
 
+// Physics runs in fixed steps of simulated time, independent of the frame rate
+const float PHYSICS_STEP_DELTA = 0.02f;
+const int MAX_PHYSICS_STEPS_PER_FRAME = 16; // Catch-up budget, 10x speed at 30 FPS still fits
+const char* CHECKPOINT_PATH = "quicksave.checkpoint";
+const float REWIND_SCRUB_STEP = 0.5f; // Simulated seconds each key repeat scrubs back
+const char* TRACE_PATH = "frame_trace.json";
+
+// Replay of a recorded trajectory, speed is in simulated seconds per real second
+const double MIN_REPLAY_SPEED = 1.0 / 16.0;
+const double MAX_REPLAY_SPEED = 1024.0;
+const double REPLAY_SEEK_FRACTION = 0.05; // Part of the recording skipped per seek key press
+
 // Manual planet movement
 bool planetControlMode = false;
 float planetMoveSpeed = 5.0f;
 
 // Global objects
+BodyStore bodyStore; // Physics state of every body, celestialBodies[i] is body i in the store
 vector<CelestialBody*> celestialBodies;
 PhysicsEngine physicsEngine;
+SimulationClock simulationClock;
+FixedStepScheduler physicsScheduler(PHYSICS_STEP_DELTA, MAX_PHYSICS_STEPS_PER_FRAME);
+PhysicsThread physicsThread(physicsEngine, bodyStore, celestialBodies, physicsScheduler);
+long long lastSnapshotStep = -1; // Step count of the snapshot the orbit trails last grew from
+int lastSnapshotReset = 0;
+PhysicsSettings lastSnapshotSettings = {}; // Engine settings of the snapshot the keyboard settings last followed
+float sentTimeScale = 1.0f; // Last time scale the physics thread was told about
+PhysicsSettings physicsSettings; // Engine settings as last requested from the keyboard
+TrajectoryPlayer trajectoryPlayer;
+bool replayMode = false; // Bodies follow a recording, the physics thread isn't started
+float rewindSeconds = 0.0f; // How far back the Z key has scrubbed
 Model sphereModel, ringModel;
+BodyRenderer bodyRenderer; // Instanced planets and stars
+OrbitBuffer orbitBuffer; // Orbit lines of every body, refilled each frame
 
 // Shaders
 Shader* planetShader = nullptr;
@@ -85,6 +134,8 @@ Shader* starShader = nullptr;
 Shader* orbitShader = nullptr;
 Shader* backgroundShader = nullptr;
 Shader* ringShader = nullptr;
+ShaderUniforms planetUniforms, starUniforms, ringUniforms;
+FrameUniformBuffer frameUniforms; // Camera and lighting shared by every shader above
 
 // Textures
 GLuint sunTexture, mercuryTexture, venusTexture, earthTexture, marsTexture, jupiterTexture, saturnTexture, uranusTexture, neptuneTexture, moonTexture;
@@ -93,193 +144,19 @@ GLuint saturnRingsTexture;
 
 // Orbit
 OrbitMode orbitMode = ORBITS_FULL;
+const int ORBIT_TRAIL_POINTS = 2000; // Minimum orbit trail distance
+const int ORBIT_TRAIL_START_POINTS = 100; // Orbit trail start distance
+const int FULL_ORBIT_SEGMENTS = 64;
 
 // Create planet, moons and stars bodies
 void createSolarSystem() {
-    float G = 0.01f; // Gravity strength
+    buildSolarSystem(bodyStore, celestialBodies);
+    simulationClock.reset();
+    physicsScheduler.reset();
 
-    for (auto body : celestialBodies) {
-        delete body;
-    }
-    celestialBodies.clear();
-
-    // Sun
-    CelestialBody* sun = new CelestialBody(
-        glm::vec3(0.0f, 0.0f, 0.0f), // Initial position
-        glm::vec3(0.0f, 0.0f, 0.0f), // Orbital velocity
-        10000.0f, // Mass
-        3.0f, // Radius
-        glm::vec3(1.0f, 0.8f, 0.2f), // Under texture color
-        "Sun", // Name
-        true // Static 'planet'
-    );
-    celestialBodies.push_back(sun);
-
-    // Mercury
-    glm::vec3 mercuryPos = glm::vec3(11.0f, 0.0f, 0.0f); // Initial position
-    float mercuryDistance = glm::length(mercuryPos); // Distance from Sun   
-    float mercurySpeed = sqrt(G * sun->mass / mercuryDistance); // Orbital speed using Newton's gravity formula
-    glm::vec3 mercuryDir = glm::normalize(glm::cross(mercuryPos, glm::vec3(0.0f, 1.0f, 0.0f))); // Orbital direction
-    glm::vec3 mercuryVel = mercuryDir * mercurySpeed; // Orbital velocity
-
-    CelestialBody* mercury = new CelestialBody(
-        mercuryPos,
-        mercuryVel,
-        0.2f,
-        0.4f,
-        glm::vec3(0.8f, 0.7f, 0.6f),
-        "Mercury"
-    );
-    mercury->rotationSpeed = 15.0f; // Rotation speed 
-    celestialBodies.push_back(mercury);
-
-    // Venus
-    glm::vec3 venusPos = glm::vec3(18.0f, 0.0f, 1.0f);
-    float venusDistance = glm::length(venusPos);
-    float venusSpeed = sqrt(G * sun->mass / venusDistance);
-    glm::vec3 venusDir = glm::normalize(glm::cross(venusPos, glm::vec3(0.0f, -1.0f, 0.0f))); // Venus rotates backwords
-    glm::vec3 venusVel = venusDir * venusSpeed;
-
-    CelestialBody* venus = new CelestialBody(
-        venusPos,
-        venusVel,
-        0.5f,
-        0.7f,
-        glm::vec3(1.0f, 0.8f, 0.4f),
-        "Venus"
-    );
-    venus->rotationSpeed = 10.0f;
-    celestialBodies.push_back(venus);
-
-    // Earth
-    glm::vec3 earthPos = glm::vec3(25.0f, 0.0f, 0.0f);
-    float earthDistance = glm::length(earthPos);
-    float earthSpeed = sqrt(G * sun->mass / earthDistance);
-    glm::vec3 earthDir = glm::normalize(glm::cross(earthPos, glm::vec3(0.0f, 1.0f, 0.0f)));
-    glm::vec3 earthVel = earthDir * earthSpeed;
-
-    CelestialBody* earth = new CelestialBody(
-        earthPos,
-        earthVel,
-        2.0f,
-        0.8f,
-        glm::vec3(0.2f, 0.4f, 1.0f),
-        "Earth"
-    );
-    earth->rotationSpeed = 20.0f;
-    celestialBodies.push_back(earth);
-
-    // Mars
-    glm::vec3 marsPos = glm::vec3(35.0f, 0.0f, 3.0f);
-    float marsDistance = glm::length(marsPos);
-    float marsSpeed = sqrt(G * sun->mass / marsDistance);
-    glm::vec3 marsDir = glm::normalize(glm::cross(marsPos, glm::vec3(0.0f, 1.0f, 0.0f)));
-    glm::vec3 marsVel = marsDir * marsSpeed;
-
-    CelestialBody* mars = new CelestialBody(
-        marsPos,
-        marsVel,
-        1.2f,
-        0.6f,
-        glm::vec3(1.0f, 0.3f, 0.2f),
-        "Mars"
-    );
-    mars->rotationSpeed = 20.0f;
-    celestialBodies.push_back(mars);
-
-    // Jupiter
-    glm::vec3 jupiterPos = glm::vec3(50.0f, 0.0f, -5.0f);
-    float jupiterDistance = glm::length(jupiterPos);
-    float jupiterSpeed = sqrt(G * sun->mass / jupiterDistance);
-    glm::vec3 jupiterDir = glm::normalize(glm::cross(jupiterPos, glm::vec3(0.0f, 1.0f, 0.0f)));
-    glm::vec3 jupiterVel = jupiterDir * jupiterSpeed;
-
-    CelestialBody* jupiter = new CelestialBody(
-        jupiterPos,
-        jupiterVel,
-        7.0f,
-        2.0f,
-        glm::vec3(0.8f, 0.6f, 0.4f),
-        "Jupiter"
-    );
-    jupiter->rotationSpeed = 40.0f; // Fast rotation
-    celestialBodies.push_back(jupiter);
-
-    // Saturn
-    glm::vec3 saturnPos = glm::vec3(70.0f, 0.0f, 4.0f);
-    float saturnDistance = glm::length(saturnPos);
-    float saturnSpeed = sqrt(G * sun->mass / saturnDistance);
-    glm::vec3 saturnDir = glm::normalize(glm::cross(saturnPos, glm::vec3(0.0f, 1.0f, 0.0f)));
-    glm::vec3 saturnVel = saturnDir * saturnSpeed;
-
-    CelestialBody* saturn = new CelestialBody(
-        saturnPos,
-        saturnVel,
-        6.0f,
-        1.5f,
-        glm::vec3(0.9f, 0.8f, 0.6f),
-        "Saturn"
-    );
-    saturn->rotationSpeed = 35.0f;
-    saturn->hasRings = true;
-    saturn->ringInnerRadius = 1.0f;  // 1.0 times Saturn's radius
-    saturn->ringOuterRadius = 2.0f;  // 2.0 times Saturn's radius
-    saturn->ringTextureID = saturnRingsTexture;
-    celestialBodies.push_back(saturn);
-
-    // Uranus
-    glm::vec3 uranusPos = glm::vec3(100.0f, 0.0f, -3.0f);
-    float uranusDistance = glm::length(uranusPos);
-    float uranusSpeed = sqrt(G * sun->mass / uranusDistance);
-    glm::vec3 uranusDir = glm::normalize(glm::cross(uranusPos, glm::vec3(0.0f, 1.0f, 0.0f)));
-    glm::vec3 uranusVel = uranusDir * uranusSpeed;
-
-    CelestialBody* uranus = new CelestialBody(
-        uranusPos,
-        uranusVel,
-        4.0f,
-        1.0f,
-        glm::vec3(0.6f, 0.8f, 0.9f),
-        "Uranus"
-    );
-    uranus->rotationSpeed = 30.0f;
-    uranus->rotationAxis = glm::vec3(0.0f, 0.0f, 1.0f); // Uranus rotates on its side
-    celestialBodies.push_back(uranus);
-
-    // Neptune
-    glm::vec3 neptunePos = glm::vec3(120.0f, 0.0f, 2.0f);
-    float neptuneDistance = glm::length(neptunePos);
-    float neptuneSpeed = sqrt(G * sun->mass / neptuneDistance);
-    glm::vec3 neptuneDir = glm::normalize(glm::cross(neptunePos, glm::vec3(0.0f, 1.0f, 0.0f)));
-    glm::vec3 neptuneVel = neptuneDir * neptuneSpeed;
-
-    CelestialBody* neptune = new CelestialBody(
-        neptunePos,
-        neptuneVel,
-        5.0f,
-        1.2f,
-        glm::vec3(0.2f, 0.4f, 0.8f),
-        "Neptune"
-    );
-    neptune->rotationSpeed = 25.0f;
-    celestialBodies.push_back(neptune);
-
-    // Moon (orbiting Earth)
-    glm::vec3 moonPos = earth->position + glm::vec3(0.0f, 0.0f, 2.0f);
-    glm::vec3 moonVel = earth->velocity;
-
-    CelestialBody* moon = new CelestialBody(
-        moonPos,
-        moonVel,
-        0.2f,
-        0.3f,
-        glm::vec3(0.7f, 0.7f, 0.7f),
-        "Moon",
-        false,
-        earth
-    );
-    moon->rotationSpeed = 5.0f; // Slow rotation
-    celestialBodies.push_back(moon);
+    celestialBodies[6]->ringTextureID = saturnRingsTexture;
+
+    physicsEngine.setClock(&simulationClock);
 
     // Assign textures
     celestialBodies[0]->textureID = sunTexture;
@@ -303,94 +180,176 @@ void createSolarSystem() {
     celestialBodies[9]->textureID = moonTexture;
     celestialBodies[9]->hasTexture = true;
 
+    physicsEngine.resolveSpecialBodies(bodyStore, celestialBodies);
+
     selectedBody = celestialBodies[0];
 }
 
+// Copies the newest physics snapshot into the bodies' render state
+void syncWithPhysics() {
+    bool changed = false;
+    const SimulationSnapshot& snapshot = physicsThread.readSnapshot(changed);
+
+    // A reset is published with the new bodies, until then keep drawing the old state
+    if (snapshot.bodies.size() != celestialBodies.size()) return;
+
+    // Trails of the old run don't belong to the new one
+    if (snapshot.resetCount != lastSnapshotReset) {
+        for (auto& body : celestialBodies) {
+            body->clearOrbit();
+        }
+        lastSnapshotReset = snapshot.resetCount;
+    }
+
+    // Loading a checkpoint, rewinding or undoing changes the engine settings behind the keyboard's back, follow them so
+    // the next key press starts from what is running. Only on a change, a pending request still counts
+    if (!(snapshot.settings == lastSnapshotSettings)) {
+        physicsSettings = snapshot.settings;
+        lastSnapshotSettings = snapshot.settings;
+    }
+
+    float alpha = PhysicsThread::getRenderInterpolation(snapshot);
+    for (size_t i = 0; i < celestialBodies.size(); i++) {
+        celestialBodies[i]->applySnapshot(snapshot.bodies[i], alpha);
+    }
+
+    // Trails grow once per published step batch
+    if (changed && snapshot.stepCount != lastSnapshotStep) {
+        for (size_t i = 0; i < celestialBodies.size(); i++) {
+            celestialBodies[i]->addOrbitPoint(snapshot.bodies[i].position);
+        }
+        lastSnapshotStep = snapshot.stepCount;
+    }
+}
+
+// Settings keys check this before touching physicsSettings, a replay has no engine to send them to
+bool canChangePhysicsSettings() {
+    if (!replayMode) return true;
+
+    cout << "Not available while replaying a recording" << endl;
+    return false;
+}
+
+// Queues a change for the physics thread, it is applied at the next step boundary
+void sendCommand(const SimulationCommand& command) {
+    if (replayMode) {
+        cout << "Not available while replaying a recording" << endl;
+        return;
+    }
+
+    if (!physicsThread.submit(command)) {
+        cout << "Physics is not keeping up, input dropped" << endl;
+    }
+}
+
+void sendImpulse(CelestialBody* body, const glm::vec3& impulse) {
+    SimulationCommand command;
+    command.type = COMMAND_APPLY_IMPULSE;
+    command.bodyId = body->id;
+    command.vector = impulse;
+    sendCommand(command);
+}
+
+void sendPhysicsSettings() {
+    SimulationCommand command;
+    command.type = COMMAND_SET_PHYSICS;
+    command.settings = physicsSettings;
+    sendCommand(command);
+}
+
+// Looks up every uniform the render loop sets, missing ones stay inactive
+ShaderUniforms resolveUniforms(const Shader* shader) {
+    ShaderUniforms uniforms;
+    uniforms.model = shader->getUniform("model");
+    uniforms.color = shader->getUniform("color");
+    uniforms.useTexture = shader->getUniform("useTexture");
+    uniforms.textureSampler = shader->getUniform("textureSampler");
+    return uniforms;
+}
+
 // Show orbit lines
 void createOrbitLines() {
+    ProfileScope profile("createOrbitLines");
+
     if (orbitMode == ORBITS_OFF) return;
 
-    orbitShader->use();
-    glm::mat4 view = camera.GetViewMatrix();
-    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 500.0f);
-    orbitShader->setMat4("view", view);
-    orbitShader->setMat4("projection", projection);
+    // Size every strip first so the whole frame is written through one mapping
+    GLsizei totalPoints = 0;
+    for (const auto& body : celestialBodies) {
+        totalPoints += orbitPointCount(body);
+    }
+    if (!orbitBuffer.begin(totalPoints)) return;
 
     for (const auto& body : celestialBodies) {
-        // Skip sun and static bodies
-        if (body->name == "Sun" || body->isStatic) continue;
+        int pointCount = orbitPointCount(body);
+        if (pointCount == 0) continue;
+
+        OrbitVertex* strip = orbitBuffer.addStrip(pointCount);
+        if (!strip) break;
 
-        vector<glm::vec3> orbitPointsToCreate;
+        glm::vec3 orbitColor = body->renderColor * 0.7f;
 
         // Generate partial orbit
         if (orbitMode == ORBITS_TRAIL) {
-            if (body->orbitPoints.size() < 2) continue;
-
-            const int MIN_POINTS = 2000; // Minimum orbit trail distance
-            const int START_POINTS = 100; // Orbit trail start distance
-
-            int totalPoints = body->orbitPoints.size();
-            orbitPointsToCreate.clear();
-
-            int pointsToShow = min(MIN_POINTS, START_POINTS + (int)((totalPoints / (float)MIN_POINTS) * (MIN_POINTS - START_POINTS)));
-            pointsToShow = max(2, pointsToShow);
-
-            for (int i = 0; i < pointsToShow; i++) {
-                float t = (float)i / (pointsToShow - 1);
-                int srcIdx = (int)(t * (totalPoints - 1));
-                srcIdx = min(srcIdx, totalPoints - 1);
-                orbitPointsToCreate.push_back(body->orbitPoints[srcIdx]);
+            int trailPoints = body->orbitPoints.size();
+
+            for (int i = 0; i < pointCount; i++) {
+                float t = (float)i / (pointCount - 1);
+                int srcIdx = (int)(t * (trailPoints - 1));
+                srcIdx = min(srcIdx, trailPoints - 1);
+                strip[i].position = body->orbitPoints[srcIdx];
+                strip[i].color = orbitColor;
             }
         }
         else if (orbitMode == ORBITS_FULL) {
             // Planet orbit
             if (body->parentBody == nullptr) {
-                generateFullOrbit(body, celestialBodies[0], orbitPointsToCreate);
+                generateFullOrbit(body, celestialBodies[0], orbitColor, strip);
             }
             else {
                 // Moons orbit
-                generateFullOrbit(body, body->parentBody, orbitPointsToCreate);
+                generateFullOrbit(body, body->parentBody, orbitColor, strip);
             }
         }
+    }
 
-        if (orbitPointsToCreate.size() < 2) continue;
+    // View and projection come from the frame uniform buffer
+    orbitShader->use();
 
-        GLuint orbitVAO, orbitVBO;
-        glGenVertexArrays(1, &orbitVAO);
-        glGenBuffers(1, &orbitVBO);
+    // Draw orbit lines
+    orbitBuffer.end();
+}
 
-        glBindVertexArray(orbitVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, orbitVBO);
-        glBufferData(GL_ARRAY_BUFFER, orbitPointsToCreate.size() * sizeof(glm::vec3), &orbitPointsToCreate[0], GL_STATIC_DRAW);
+// Orbit line vertices drawn for a body, 0 if it shows none
+int orbitPointCount(CelestialBody* body) {
+    // Skip sun and static bodies
+    if (body->isStar() || body->isStatic()) return 0;
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    if (orbitMode == ORBITS_TRAIL) {
+        int totalPoints = body->orbitPoints.size();
+        if (totalPoints < 2) return 0;
 
-        glm::vec3 orbitColor = body->color * 0.7f;
-        orbitShader->setVec3("color", orbitColor);
+        int pointsToShow = min(ORBIT_TRAIL_POINTS, ORBIT_TRAIL_START_POINTS + (int)((totalPoints / (float)ORBIT_TRAIL_POINTS) * (ORBIT_TRAIL_POINTS - ORBIT_TRAIL_START_POINTS)));
+        return max(2, pointsToShow);
+    }
 
-        // Draw orbit line
-        glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(orbitPointsToCreate.size()));
+    if (orbitMode == ORBITS_FULL) return FULL_ORBIT_SEGMENTS + 1;
 
-        glDeleteVertexArrays(1, &orbitVAO);
-        glDeleteBuffers(1, &orbitVBO);
-    }
+    return 0;
 }
 
 // Generates full circular orbits
-void generateFullOrbit(CelestialBody* body, CelestialBody* centralBody, vector<glm::vec3>& orbitPoints) {
-    orbitPoints.clear();
-
+void generateFullOrbit(CelestialBody* body, CelestialBody* centralBody, const glm::vec3& color, OrbitVertex* orbitPoints) {
     // Calculate orbit radius (distance from sun)
-    glm::vec3 toBody = body->position - centralBody->position;
+    glm::vec3 toBody = body->renderPosition - centralBody->renderPosition;
     float orbitRadius = glm::length(toBody);
 
-    glm::vec3 normal = glm::normalize(glm::cross(toBody, body->velocity));
+    glm::vec3 normal = glm::normalize(glm::cross(toBody, body->renderVelocity));
     if (glm::length(normal) < 0.1f) {
         normal = glm::vec3(0.0f, 1.0f, 0.0f);
     }
 
-    const int segments = 64;
+    const int segments = FULL_ORBIT_SEGMENTS;
     for (int i = 0; i <= segments; i++) {
         float angle = 2.0f * glm::pi<float>() * i / segments;
 
@@ -406,8 +365,9 @@ void generateFullOrbit(CelestialBody* body, CelestialBody* centralBody, vector<g
 
         glm::vec3 orbitDir = glm::vec3(rotation * glm::vec4(initialDir, 0.0f));
 
-        glm::vec3 orbitPoint = centralBody->position + orbitDir * orbitRadius;
-        orbitPoints.push_back(orbitPoint);
+        glm::vec3 orbitPoint = centralBody->renderPosition + orbitDir * orbitRadius;
+        orbitPoints[i].position = orbitPoint;
+        orbitPoints[i].color = color;
     }
 }
 
@@ -419,6 +379,23 @@ void menu() {
     cout << "P: Pause/Resume simulation" << endl;
     cout << "O: Cycle orbit modes" << endl;
     cout << "R: Reset simulation" << endl;
+    cout << "G: Toggle gravity solver (Direct / Barnes-Hut)" << endl;
+    cout << "[ and ]: Decrease/Increase Barnes-Hut opening angle" << endl;
+    cout << "K: Cycle direct gravity kernel (Scalar / AVX2 / AVX-512)" << endl;
+    cout << "T: Cycle physics thread count" << endl;
+    cout << "I: Cycle integrator (Euler / Leapfrog / Yoshida / Forest-Ruth)" << endl;
+    cout << "B: Toggle individual block timesteps" << endl;
+    cout << "F5: Save checkpoint" << endl;
+    cout << "F9: Load checkpoint" << endl;
+    cout << "F3: Toggle frame profiling, F4: Export it as a Chrome trace" << endl;
+
+    if (replayMode) {
+        cout << "\nReplaying a recording, P pauses and R goes back to the start" << endl;
+        cout << "+/-: Faster/Slower playback, 0: Normal speed" << endl;
+        cout << "V: Reverse playback" << endl;
+        cout << ", and .: Seek backward/forward" << endl;
+        cout << "Home and End: Jump to the start/end" << endl;
+    }
 
     cout << "\nTAB: Select and auto-follow next planet" << endl;
     cout << "CTRL+TAB: Select and auto-follow previous planet" << endl;
@@ -430,10 +407,24 @@ void menu() {
     cout << "\nArrow Keys: Apply horizontal impulse to selected body" << endl;
     cout << "Page Up and Page Down Keys: Apply vertical impulse to selected body" << endl;
     cout << "Backspace: Stop selected body" << endl;
+    cout << "Z (hold): Scrub back in time, the simulation continues from there when released" << endl;
+    cout << "CTRL+Z: Undo the last impulse or stop" << endl;
     cout << "================\n" << endl;
 }
 
-int main() {
+// Reports where playback is after a replay key
+void printReplayState() {
+    cout << "Replay: " << trajectoryPlayer.getTime() << "s of " << trajectoryPlayer.getEndTime() << "s, speed "
+         << trajectoryPlayer.getSpeed() << "x" << (trajectoryPlayer.isPaused() ? " (paused)" : "") << endl;
+}
+
+int main(int argc, char** argv) {
+    // SolarSystemSimulator --replay <file> plays a recording from HeadlessRunner --record instead of simulating
+    string replayPath;
+    if (argc > 2 && string(argv[1]) == "--replay") {
+        replayPath = argv[2];
+    }
+
     // Initialize GLFW
     if (!glfwInit()) {
         cout << "Failed to initialize GLFW" << endl;
@@ -485,6 +476,22 @@ int main() {
 
         ringShader = new Shader("../shaders/ring.vertex", "../shaders/ring.fragment");
         cout << "Ring shader loaded successfully" << endl;
+
+        planetUniforms = resolveUniforms(planetShader);
+        starUniforms = resolveUniforms(starShader);
+        ringUniforms = resolveUniforms(ringShader);
+
+        frameUniforms.create();
+        frameUniforms.attach(planetShader);
+        frameUniforms.attach(starShader);
+        frameUniforms.attach(orbitShader);
+        frameUniforms.attach(ringShader);
+
+        // Body textures always come from unit 0
+        planetShader->use();
+        planetShader->setInt(planetUniforms.textureSampler, 0);
+        starShader->use();
+        starShader->setInt(starUniforms.textureSampler, 0);
     }
     catch (const exception& e) {
         cout << "Shader loading failed: " << e.what() << endl;
@@ -500,19 +507,60 @@ int main() {
     sphereModel.createSphere(1.0f, 64, 64);
     // Create ring model
     ringModel.createRing(1.0f, 2.5f, 64);
+    // Create orbit line buffer
+    orbitBuffer.create();
 
     // Create solar system
     createSolarSystem();
+    bodyRenderer.create(celestialBodies, sphereModel);
+
+    if (!replayPath.empty()) {
+        replayMode = trajectoryPlayer.open(replayPath, celestialBodies);
+        if (!replayMode) {
+            cout << "Could not replay " << replayPath << ", simulating instead" << endl;
+        }
+    }
     menu();
 
+    physicsSettings = physicsEngine.getSettings();
+    lastSnapshotSettings = physicsSettings;
+    if (!replayMode) {
+        physicsThread.setCheckpointPath(CHECKPOINT_PATH);
+        physicsThread.start();
+    }
+
+    Profiler::setThreadName("Render");
+
     while (!glfwWindowShouldClose(window)) {
+        ProfileScope frameProfile("Frame");
+
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
 
         lastFrame = currentFrame;
 
+        ProfileScope inputProfile("Input");
         processInput(window);
         checkManualCameraControl(window);
+        inputProfile.end();
+
+        ProfileScope syncProfile("Sync physics");
+        if (replayMode) {
+            trajectoryPlayer.advance(deltaTime);
+            trajectoryPlayer.apply(celestialBodies);
+        }
+        else {
+            // Physics runs on its own thread, tell it about speed changes and take over its latest state
+            float wantedTimeScale = simulationRunning ? timeScale : 0.0f;
+            if (wantedTimeScale != sentTimeScale) {
+                SimulationCommand command;
+                command.type = COMMAND_SET_TIME_SCALE;
+                command.value = wantedTimeScale;
+                if (physicsThread.submit(command)) sentTimeScale = wantedTimeScale;
+            }
+            syncWithPhysics();
+        }
+        syncProfile.end();
 
         if (cameraFollowMode && selectedBody) {
             updateCameraToFollowBody(selectedBody);
@@ -529,26 +577,21 @@ int main() {
         glDrawArrays(GL_TRIANGLES, 0, 6);
         glEnable(GL_DEPTH_TEST);
 
-        if (simulationRunning) {
-            int physicsSubsteps = 4;
-            float substepDelta = (deltaTime * timeScale) / physicsSubsteps;
-
-            for (int i = 0; i < physicsSubsteps; i++) {
-                physicsEngine.updatePhysics(celestialBodies, substepDelta);
-            }
-        }
-
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 500.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        glm::vec3 sunPosition = celestialBodies[0]->position;
+        glm::vec3 sunPosition = celestialBodies[0]->renderPosition;
+
+        // Camera and lighting for every shader, uploaded once
+        frameUniforms.update(projection, view, sunPosition, glm::vec3(1.0f, 1.0f, 0.9f), camera.Position);
 
         // Create rings with shaders
+        ProfileScope ringProfile("Ring draw");
         for (const auto& body : celestialBodies) {
             if (body->hasRings && saturnRingsTexture != 0) {
                 ringShader->use();
 
                 glm::mat4 ringModelMatrix = glm::mat4(1.0f);
-                ringModelMatrix = glm::translate(ringModelMatrix, body->position);
+                ringModelMatrix = glm::translate(ringModelMatrix, body->renderPosition);
 
                 // Rings tilt
                 ringModelMatrix = glm::rotate(ringModelMatrix, glm::radians(10.0f), glm::vec3(1.0f, 0.0f, 0.5f));
@@ -557,15 +600,13 @@ int main() {
                 ringModelMatrix = glm::scale(ringModelMatrix,
                     glm::vec3(ringScale, 0.001f, ringScale)); // Rings thickness
 
-                ringShader->setMat4("model", ringModelMatrix);
-                ringShader->setMat4("view", view);
-                ringShader->setMat4("projection", projection);
-                ringShader->setVec3("color", glm::vec3(1.0f, 1.0f, 1.0f));
-                ringShader->setBool("useTexture", true);
+                ringShader->setMat4(ringUniforms.model, ringModelMatrix);
+                ringShader->setVec3(ringUniforms.color, glm::vec3(1.0f, 1.0f, 1.0f));
+                ringShader->setBool(ringUniforms.useTexture, true);
 
                 glActiveTexture(GL_TEXTURE0);
                 glBindTexture(GL_TEXTURE_2D, saturnRingsTexture);
-                ringShader->setInt("textureSampler", 0);
+                ringShader->setInt(ringUniforms.textureSampler, 0);
 
                 glEnable(GL_BLEND);
                 glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -577,53 +618,27 @@ int main() {
             }
         }
 
-        // Create planet bodies with shaders
-        for (const auto& body : celestialBodies) {
-            if (body->name == "Sun") {
-                starShader->use();
-                starShader->setMat4("projection", projection);
-                starShader->setMat4("view", view);
-                starShader->setMat4("model", body->getModelMatrix());
-                starShader->setVec3("color", body->color);
-                starShader->setBool("useTexture", body->hasTexture);
-
-                if (body->hasTexture) {
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, body->textureID);
-                    starShader->setInt("textureSampler", 0);
-                }
-            }
-            else {
-                planetShader->use();
-                planetShader->setMat4("projection", projection);
-                planetShader->setMat4("view", view);
-                planetShader->setMat4("model", body->getModelMatrix());
-                planetShader->setVec3("color", body->color);
-                planetShader->setVec3("lightPos", sunPosition);
-                planetShader->setVec3("lightColor", glm::vec3(1.0f, 1.0f, 0.9f));
-                planetShader->setVec3("viewPos", camera.Position);
-                planetShader->setBool("useTexture", body->hasTexture);
-                planetShader->setBool("inShadow", body->isInShadow);
-                planetShader->setFloat("shadowIntensity", body->shadowIntensity);
-                planetShader->setVec3("shadowDirection", body->shadowDirection);
-
-                if (body->hasTexture) {
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, body->textureID);
-                    planetShader->setInt("textureSampler", 0);
-                }
-            }
+        ringProfile.end();
 
-            sphereModel.create();
-        }
+        // Create planet bodies with shaders, one instanced draw per material
+        ProfileScope planetProfile("Planet draw");
+        bodyRenderer.draw(celestialBodies, starShader, planetShader);
+        planetProfile.end();
 
         // Create orbit lines
         createOrbitLines();
 
+        ProfileScope swapProfile("Swap");
         glfwSwapBuffers(window);
+        swapProfile.end();
+
+        // Key callbacks run in here
+        ProfileScope eventsProfile("Poll events");
         glfwPollEvents();
     }
 
+    physicsThread.stop();
+
     for (auto body : celestialBodies) {
         delete body;
     }
@@ -647,6 +662,9 @@ int main() {
 
     glDeleteVertexArrays(1, &backgroundVAO);
     glDeleteBuffers(1, &backgroundVBO);
+    frameUniforms.destroy();
+    bodyRenderer.destroy();
+    orbitBuffer.destroy();
 
     glfwTerminate();
     return 0;
@@ -774,6 +792,28 @@ void processInput(GLFWwindow* window) {
 
 // Process simulation controls button clicks
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    // Z Key, held down: shows the simulation further back with every repeat, rewinds to there when let go
+    if (key == GLFW_KEY_Z && !replayMode && !(mods & GLFW_MOD_CONTROL)) {
+        SimulationCommand command;
+
+        if (action == GLFW_PRESS || action == GLFW_REPEAT) {
+            rewindSeconds += REWIND_SCRUB_STEP;
+            command.type = COMMAND_SCRUB;
+        }
+        else if (action == GLFW_RELEASE && rewindSeconds > 0.0f) {
+            command.type = COMMAND_REWIND;
+        }
+        else {
+            return;
+        }
+
+        command.value = rewindSeconds;
+        sendCommand(command);
+
+        if (command.type == COMMAND_REWIND) rewindSeconds = 0.0f;
+        return;
+    }
+
     if (action == GLFW_PRESS) {
         float impulseStrength = 1.0f;
 
@@ -781,6 +821,11 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
         // P Key
         case GLFW_KEY_P:
+            if (replayMode) {
+                trajectoryPlayer.setPaused(!trajectoryPlayer.isPaused());
+                printReplayState();
+                break;
+            }
             simulationRunning = !simulationRunning;
             cout << "Simulation " << (simulationRunning ? "Resumed" : "Paused") << endl;
             break;
@@ -804,10 +849,20 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             break;
 
         // R Key
-        case GLFW_KEY_R:
-            createSolarSystem();
+        case GLFW_KEY_R: {
+            if (replayMode) {
+                trajectoryPlayer.seek(trajectoryPlayer.getStartTime());
+                printReplayState();
+                break;
+            }
+
+            SimulationCommand command;
+            command.type = COMMAND_RESET;
+            sendCommand(command);
+
             timeScale = 1.0f;
             selectedBodyIndex = 0;
+            selectedBody = celestialBodies[0];
 
             #ifdef _WIN32
                 system("cls");
@@ -817,6 +872,115 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
             menu();
             break;
+        }
+
+        // G Key
+        case GLFW_KEY_G:
+            if (!canChangePhysicsSettings()) break;
+            if (physicsSettings.gravityMode == GRAVITY_DIRECT) {
+                physicsSettings.gravityMode = GRAVITY_BARNES_HUT;
+                cout << "Gravity: BARNES-HUT (theta " << physicsSettings.openingAngle << ")" << endl;
+            }
+            else {
+                physicsSettings.gravityMode = GRAVITY_DIRECT;
+                cout << "Gravity: DIRECT (all pairs)" << endl;
+            }
+            sendPhysicsSettings();
+            break;
+
+        // [ Key
+        case GLFW_KEY_LEFT_BRACKET:
+            if (!canChangePhysicsSettings()) break;
+            physicsSettings.openingAngle = glm::clamp(physicsSettings.openingAngle - 0.1f, 0.0f, 2.0f);
+            sendPhysicsSettings();
+            cout << "Barnes-Hut theta: " << physicsSettings.openingAngle << endl;
+            break;
+
+        // ] Key
+        case GLFW_KEY_RIGHT_BRACKET:
+            if (!canChangePhysicsSettings()) break;
+            physicsSettings.openingAngle = glm::clamp(physicsSettings.openingAngle + 0.1f, 0.0f, 2.0f);
+            sendPhysicsSettings();
+            cout << "Barnes-Hut theta: " << physicsSettings.openingAngle << endl;
+            break;
+
+        // K Key
+        case GLFW_KEY_K: {
+            if (!canChangePhysicsSettings()) break;
+
+            // Next kernel the CPU supports, wrapping around to scalar
+            GravityKernel kernel = physicsSettings.gravityKernel;
+            do {
+                kernel = static_cast<GravityKernel>((kernel + 1) % 3);
+            } while (!isKernelSupported(kernel));
+
+            physicsSettings.gravityKernel = kernel;
+            sendPhysicsSettings();
+            cout << "Gravity kernel: " << getKernelName(kernel) << endl;
+            break;
+        }
+
+        // T Key
+        case GLFW_KEY_T: {
+            if (!canChangePhysicsSettings()) break;
+
+            // Doubles the thread count up to the hardware limit, then back to one
+            int threads = physicsSettings.threadCount * 2;
+            if (threads > ThreadPool::getHardwareThreads()) threads = 1;
+
+            physicsSettings.threadCount = threads;
+            sendPhysicsSettings();
+            cout << "Physics threads: " << threads << endl;
+            break;
+        }
+
+        // I Key
+        case GLFW_KEY_I: {
+            if (!canChangePhysicsSettings()) break;
+
+            Integrator integrator = static_cast<Integrator>((physicsSettings.integrator + 1) % INTEGRATOR_COUNT);
+            physicsSettings.integrator = integrator;
+            sendPhysicsSettings();
+            cout << "Integrator: " << getIntegratorName(integrator) << endl;
+            break;
+        }
+
+        // B Key
+        case GLFW_KEY_B:
+            if (!canChangePhysicsSettings()) break;
+            physicsSettings.blockTimesteps = !physicsSettings.blockTimesteps;
+            sendPhysicsSettings();
+            cout << "Block timesteps: " << (physicsSettings.blockTimesteps ? "ON" : "OFF") << endl;
+            break;
+
+        // F5 Key
+        case GLFW_KEY_F5: {
+            SimulationCommand command;
+            command.type = COMMAND_SAVE_CHECKPOINT;
+            sendCommand(command);
+            break;
+        }
+
+        // F9 Key
+        case GLFW_KEY_F9: {
+            SimulationCommand command;
+            command.type = COMMAND_LOAD_CHECKPOINT;
+            sendCommand(command);
+            break;
+        }
+
+        // F3 Key
+        case GLFW_KEY_F3:
+            Profiler::setEnabled(!Profiler::isEnabled());
+            cout << "Frame profiling: " << (Profiler::isEnabled() ? "ON" : "OFF") << endl;
+            break;
+
+        // F4 Key
+        case GLFW_KEY_F4:
+            if (!Profiler::exportChromeTrace(TRACE_PATH)) {
+                cout << "Could not write " << TRACE_PATH << endl;
+            }
+            break;
 
         // TAB Key
         case GLFW_KEY_TAB:
@@ -836,7 +1000,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             cameraManualControl = false;
             resetCameraLook();
 
-            if (selectedBody->name != "Sun") {
+            if (!selectedBody->isStar()) {
                 cout << "Selected: " << selectedBody->name << " (Camera following)" << endl;
             }
             else {
@@ -859,44 +1023,40 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 updateCameraToFollowBody(selectedBody);
             }
 
-            if (selectedBody && selectedBody->name != "Sun") {
+            if (selectedBody && !selectedBody->isStar()) {
                 cout << "Camera reset to auto-follow" << endl;
             }
             break;
 
         // Arrow UP Key
         case GLFW_KEY_UP:
-            if (selectedBody && !selectedBody->isStatic && selectedBody->name != "Sun") {
+            if (selectedBody && !selectedBody->isStatic() && !selectedBody->isStar()) {
                 // UP: Push away from Sun (accumulate)
-                glm::vec3 toSun = celestialBodies[0]->position - selectedBody->position;
+                glm::vec3 toSun = celestialBodies[0]->renderPosition - selectedBody->renderPosition;
                 glm::vec3 sunDir = glm::normalize(toSun);
-                selectedBody->velocity += sunDir * 1.5f; // Power of pull
+                sendImpulse(selectedBody, sunDir * 1.5f); // Power of pull
                 cout << "Pulling " << selectedBody->name << " toward Sun" << endl;
             }
             break;
 
         // Arrow DOWN Key
         case GLFW_KEY_DOWN:
-            if (selectedBody && !selectedBody->isStatic && selectedBody->name != "Sun") {
+            if (selectedBody && !selectedBody->isStatic() && !selectedBody->isStar()) {
                 // DOWN: Pull toward Sun (accumulate)
-                glm::vec3 toSun = celestialBodies[0]->position - selectedBody->position;
+                glm::vec3 toSun = celestialBodies[0]->renderPosition - selectedBody->renderPosition;
                 glm::vec3 sunDir = glm::normalize(toSun);
-                selectedBody->velocity -= sunDir * 1.0f; // Power of push
+                sendImpulse(selectedBody, -sunDir * 1.0f); // Power of push
                 cout << "Pushing " << selectedBody->name << " away from Sun" << endl;
             }
             break;
 
         // Arrow LEFT Key
         case GLFW_KEY_LEFT:
-            if (selectedBody && !selectedBody->isStatic && selectedBody->name != "Sun") {
+            if (selectedBody && !selectedBody->isStatic() && !selectedBody->isStar()) {
                 // LEFT: Add counter-clockwise orbital velocity (accumulate)
-                glm::vec3 toSun = celestialBodies[0]->position - selectedBody->position;
+                glm::vec3 toSun = celestialBodies[0]->renderPosition - selectedBody->renderPosition;
                 glm::vec3 tangentDir = glm::normalize(glm::cross(toSun, glm::vec3(0.0f, 1.0f, 0.0f)));
-                selectedBody->velocity -= tangentDir * 0.3f; // Negative for counter-clockwise
-
-                // Calculate current orbital speed direction
-                glm::vec3 orbitalVel = selectedBody->velocity - celestialBodies[0]->velocity;
-                float tangentSpeed = glm::dot(orbitalVel, tangentDir);
+                sendImpulse(selectedBody, -tangentDir * 0.3f); // Negative for counter-clockwise
 
                 cout << "Adding counter-clockwise spin to " << selectedBody->name << endl;
             }
@@ -904,15 +1064,11 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
         // Arrow RIGHT Key
         case GLFW_KEY_RIGHT:
-            if (selectedBody && !selectedBody->isStatic && selectedBody->name != "Sun") {
+            if (selectedBody && !selectedBody->isStatic() && !selectedBody->isStar()) {
                 // RIGHT: Add clockwise orbital velocity (accumulate)
-                glm::vec3 toSun = celestialBodies[0]->position - selectedBody->position;
+                glm::vec3 toSun = celestialBodies[0]->renderPosition - selectedBody->renderPosition;
                 glm::vec3 tangentDir = glm::normalize(glm::cross(toSun, glm::vec3(0.0f, 1.0f, 0.0f)));
-                selectedBody->velocity += tangentDir * 0.3f; // Positive for clockwise
-
-                // Calculate current orbital speed direction
-                glm::vec3 orbitalVel = selectedBody->velocity - celestialBodies[0]->velocity;
-                float tangentSpeed = glm::dot(orbitalVel, tangentDir);
+                sendImpulse(selectedBody, tangentDir * 0.3f); // Positive for clockwise
 
                 cout << "Adding clockwise spin to " << selectedBody->name << endl;
             }
@@ -920,34 +1076,44 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
         // Page UP Key
         case GLFW_KEY_PAGE_UP:
-            if (selectedBody && !selectedBody->isStatic) {
+            if (selectedBody && !selectedBody->isStatic()) {
                 // Page Up: Apply impulse in camera up direction
                 glm::vec3 impulse = camera.Up * impulseStrength;
-                selectedBody->velocity += impulse;
+                sendImpulse(selectedBody, impulse);
                 cout << "Applied camera-up impulse to " << selectedBody->name << endl;
             }
             break;
 
         // Page DOWN Key
         case GLFW_KEY_PAGE_DOWN:
-            if (selectedBody && !selectedBody->isStatic) {
+            if (selectedBody && !selectedBody->isStatic()) {
                 // Page Down: Apply impulse in camera down direction
                 glm::vec3 impulse = -camera.Up * impulseStrength;
-                selectedBody->velocity += impulse;
+                sendImpulse(selectedBody, impulse);
                 cout << "Applied camera-down impulse to " << selectedBody->name << endl;
             }
             break;
 
         // Backspace Key
         case GLFW_KEY_BACKSPACE:
-            if (selectedBody && !selectedBody->isStatic) {
-                selectedBody->velocity = glm::vec3(0.0f);
+            if (selectedBody && !selectedBody->isStatic()) {
+                SimulationCommand command;
+                command.type = COMMAND_STOP_BODY;
+                command.bodyId = selectedBody->id;
+                sendCommand(command);
                 cout << "Stopped " << selectedBody->name << endl;
             }
             break;
 
         // + Key
         case GLFW_KEY_KP_ADD:
+            if (replayMode) {
+                double speed = trajectoryPlayer.getSpeed();
+                trajectoryPlayer.setSpeed(speed < 0.0 ? max(speed * 2.0, -MAX_REPLAY_SPEED) : min(speed * 2.0, MAX_REPLAY_SPEED));
+                printReplayState();
+                break;
+            }
+
             if (timeScale != MIN_TIME_SCALE) {
                 timeScale = min(timeScale + TIME_SCALE_STEP, MAX_TIME_SCALE);
             }
@@ -960,6 +1126,13 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
         // - Key
         case GLFW_KEY_KP_SUBTRACT:
+            if (replayMode) {
+                double speed = trajectoryPlayer.getSpeed();
+                trajectoryPlayer.setSpeed(speed < 0.0 ? min(speed * 0.5, -MIN_REPLAY_SPEED) : max(speed * 0.5, MIN_REPLAY_SPEED));
+                printReplayState();
+                break;
+            }
+
             timeScale = max(timeScale - TIME_SCALE_STEP, MIN_TIME_SCALE);
             cout << "Time speed: " << timeScale << "x" << endl;
             break;
@@ -967,9 +1140,52 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         // 0 Key
         case GLFW_KEY_0:
         case GLFW_KEY_KP_0:
+            if (replayMode) {
+                trajectoryPlayer.setSpeed(trajectoryPlayer.getSpeed() < 0.0 ? -1.0 : 1.0);
+                printReplayState();
+                break;
+            }
+
             timeScale = 1.0f;
             cout << "Time speed reset to: " << timeScale << "x" << endl;
             break;
+
+        // CTRL + Z Keys
+        case GLFW_KEY_Z:
+            if (mods & GLFW_MOD_CONTROL) {
+                SimulationCommand command;
+                command.type = COMMAND_UNDO;
+                sendCommand(command);
+            }
+            break;
+
+        // V Key
+        case GLFW_KEY_V:
+            if (replayMode) {
+                trajectoryPlayer.setSpeed(-trajectoryPlayer.getSpeed());
+                trajectoryPlayer.setPaused(false);
+                printReplayState();
+            }
+            break;
+
+        // , and . Keys
+        case GLFW_KEY_COMMA:
+        case GLFW_KEY_PERIOD:
+            if (replayMode) {
+                double step = (trajectoryPlayer.getEndTime() - trajectoryPlayer.getStartTime()) * REPLAY_SEEK_FRACTION;
+                trajectoryPlayer.seek(trajectoryPlayer.getTime() + (key == GLFW_KEY_COMMA ? -step : step));
+                printReplayState();
+            }
+            break;
+
+        // Home and End Keys
+        case GLFW_KEY_HOME:
+        case GLFW_KEY_END:
+            if (replayMode) {
+                trajectoryPlayer.seek(key == GLFW_KEY_HOME ? trajectoryPlayer.getStartTime() : trajectoryPlayer.getEndTime());
+                printReplayState();
+            }
+            break;
         }
     }
 }
@@ -979,14 +1195,14 @@ void updateCameraToFollowBody(CelestialBody* body) {
     if (!body || !cameraFollowMode) return;
 
     // Special handling for Sun
-    if (body->name == "Sun") {
+    if (body->isStar()) {
         if (!cameraManualControl) {
-            camera.Position = body->position + glm::vec3(0.0f, 8.0f, 25.0f);
+            camera.Position = body->renderPosition + glm::vec3(0.0f, 8.0f, 25.0f);
         }
 
         // Camera position to look at Sun
         if (!cameraManualLook) {
-            camera.Front = glm::normalize(body->position - camera.Position);
+            camera.Front = glm::normalize(body->renderPosition - camera.Position);
             camera.Right = glm::normalize(glm::cross(camera.Front, camera.WorldUp));
             camera.Up = glm::normalize(glm::cross(camera.Right, camera.Front));
             camera.Yaw = glm::degrees(atan2(camera.Front.z, camera.Front.x));
@@ -996,23 +1212,23 @@ void updateCameraToFollowBody(CelestialBody* body) {
     }
 
     // Special handling for Moon
-    if (body->name == "Moon" && body->parentBody) {
-        glm::vec3 moonToEarth = body->parentBody->position - body->position;
+    if (body->isMoon() && body->parentBody) {
+        glm::vec3 moonToEarth = body->parentBody->renderPosition - body->renderPosition;
         glm::vec3 earthDir = glm::normalize(moonToEarth);
 
-        float scaledFollowDistance = 2.0f + (body->radius * 2.0f);
-        float scaledFollowHeight = followHeight + (body->radius * 0.5f);
+        float scaledFollowDistance = 2.0f + (body->renderRadius * 2.0f);
+        float scaledFollowHeight = followHeight + (body->renderRadius * 0.5f);
 
         glm::vec3 cameraOffset = -earthDir * scaledFollowDistance;
         cameraOffset.y += scaledFollowHeight;
 
         if (!cameraManualControl) {
-            camera.Position = body->position + cameraOffset;
+            camera.Position = body->renderPosition + cameraOffset;
         }
 
         // Camera position to look at Moon
         if (!cameraManualLook) {
-            glm::vec3 desiredFront = glm::normalize(body->position - camera.Position);
+            glm::vec3 desiredFront = glm::normalize(body->renderPosition - camera.Position);
             camera.Front = desiredFront;
             camera.Right = glm::normalize(glm::cross(camera.Front, camera.WorldUp));
             camera.Up = glm::normalize(glm::cross(camera.Right, camera.Front));
@@ -1022,25 +1238,25 @@ void updateCameraToFollowBody(CelestialBody* body) {
         return;
     }
 
-    glm::vec3 toSun = celestialBodies[0]->position - body->position;
+    glm::vec3 toSun = celestialBodies[0]->renderPosition - body->renderPosition;
     glm::vec3 orbitalDir = glm::normalize(glm::cross(toSun, glm::vec3(0.0f, 1.0f, 0.0f)));
 
     if (glm::length(orbitalDir) < 0.1f) {
         orbitalDir = glm::vec3(0.0f, 0.0f, 1.0f);
     }
 
-    float scaledFollowDistance = minFollowDistance + (body->radius * distanceMultiplier);
-    float scaledFollowHeight = followHeight + (body->radius * 0.5f);
+    float scaledFollowDistance = minFollowDistance + (body->renderRadius * distanceMultiplier);
+    float scaledFollowHeight = followHeight + (body->renderRadius * 0.5f);
 
     glm::vec3 cameraOffset = glm::vec3(-scaledFollowDistance, scaledFollowHeight, 0.0f);
 
     if (!cameraManualControl) {
-        camera.Position = body->position + cameraOffset;
+        camera.Position = body->renderPosition + cameraOffset;
     }
 
     // Camera position to look at planet
     if (!cameraManualLook) {
-        camera.Front = glm::normalize(body->position - camera.Position);
+        camera.Front = glm::normalize(body->renderPosition - camera.Position);
         camera.Right = glm::normalize(glm::cross(camera.Front, camera.WorldUp));
         camera.Up = glm::normalize(glm::cross(camera.Right, camera.Front));
         camera.Yaw = glm::degrees(atan2(camera.Front.z, camera.Front.x));
@@ -0,0 +1,44 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+
+using namespace std;
+
+// Fixed size lock-free ring for exactly one producer thread and one consumer thread.
+// Capacity must be a power of two, push fails instead of waiting when the ring is full
+template <typename T, unsigned int Capacity>
+class SpscQueue {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer side
+    bool push(const T& item) {
+        unsigned int currentTail = tail.load(memory_order_relaxed);
+        if (currentTail - head.load(memory_order_acquire) == Capacity) return false;
+
+        items[currentTail & (Capacity - 1)] = item;
+        tail.store(currentTail + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        unsigned int currentHead = head.load(memory_order_relaxed);
+        if (currentHead == tail.load(memory_order_acquire)) return false;
+
+        item = items[currentHead & (Capacity - 1)];
+        head.store(currentHead + 1, memory_order_release);
+        return true;
+    }
+
+private:
+    // Each index on its own cache line so the two threads don't keep stealing it from each other
+    alignas(64) atomic<unsigned int> head;
+    alignas(64) atomic<unsigned int> tail;
+    alignas(64) T items[Capacity];
+};
+
+#endif
\ No newline at end of file
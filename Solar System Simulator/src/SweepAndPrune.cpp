@@ -0,0 +1,50 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+using namespace std;
+
+SweepAndPrune::SweepAndPrune() {}
+
+const vector<pair<int, int>>& SweepAndPrune::findCandidates(const BodyStore& store, float margin) {
+    int count = store.size();
+    candidates.clear();
+
+    minX.resize(count);
+    maxX.resize(count);
+    for (int i = 0; i < count; i++) {
+        float extent = store.radius[i] + margin;
+        minX[i] = static_cast<float>(store.x[i]) - extent;
+        maxX[i] = static_cast<float>(store.x[i]) + extent;
+    }
+
+    // A new scene starts from scratch, otherwise the previous order is nearly sorted already
+    if (static_cast<int>(order.size()) != count) {
+        order.resize(count);
+        for (int i = 0; i < count; i++) order[i] = i;
+        sort(order.begin(), order.end(), [&](int a, int b) { return minX[a] < minX[b]; });
+    }
+    else {
+        // Insertion sort, linear when only a few bodies swapped places
+        for (int i = 1; i < count; i++) {
+            int body = order[i];
+            int j = i - 1;
+            while (j >= 0 && minX[order[j]] > minX[body]) {
+                order[j + 1] = order[j];
+                j--;
+            }
+            order[j + 1] = body;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        int a = order[i];
+
+        for (int j = i + 1; j < count && minX[order[j]] <= maxX[a]; j++) {
+            int b = order[j];
+            candidates.push_back(a < b ? make_pair(a, b) : make_pair(b, a));
+        }
+    }
+
+    sort(candidates.begin(), candidates.end());
+    return candidates;
+}
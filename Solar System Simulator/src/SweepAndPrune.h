@@ -0,0 +1,27 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+#include <vector>
+#include <utility>
+#include "BodyStore.h"
+
+using namespace std;
+
+// Broad phase for collisions: bodies are kept sorted by the low end of their extent on the x axis,
+// only bodies whose extents overlap there become candidate pairs.
+// The order is kept between calls, bodies barely move per substep so re-sorting is almost free
+class SweepAndPrune {
+public:
+    SweepAndPrune();
+
+    // Candidate pairs (a, b) with a < b in the same order as a loop over all pairs
+    const vector<pair<int, int>>& findCandidates(const BodyStore& store, float margin);
+
+private:
+    vector<int> order;      // Body indices sorted by minX
+    vector<float> minX;
+    vector<float> maxX;
+    vector<pair<int, int>> candidates;
+};
+
+#endif
\ No newline at end of file
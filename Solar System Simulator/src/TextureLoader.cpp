@@ -1,6 +1,7 @@
 #include "TextureLoader.h"
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../stb_image.h"
@@ -67,4 +68,46 @@ GLuint createDefaultTexture(glm::vec3 color) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     return textureID;
+}
+
+// Copies 2D textures of any size into the layers of one RGBA texture array, layer i holds textures[i]
+GLuint createTextureArray(const vector<GLuint>& textures, int width, int height) {
+    GLuint arrayID;
+    glGenTextures(1, &arrayID);
+
+    GLsizei layers = max((GLsizei)textures.size(), 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    // Scale each texture into its layer on the GPU
+    GLuint framebuffers[2];
+    glGenFramebuffers(2, framebuffers);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+
+    for (size_t layer = 0; layer < textures.size(); layer++) {
+        GLint sourceWidth = 0, sourceHeight = 0;
+        glBindTexture(GL_TEXTURE_2D, textures[layer]);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &sourceWidth);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &sourceHeight);
+
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[layer], 0);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, arrayID, 0, (GLint)layer);
+        glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(2, framebuffers);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    return arrayID;
 }
\ No newline at end of file
@@ -4,7 +4,9 @@
 #include <GL/glew.h>
 #include <string>
 #include <glm/glm.hpp>
+#include <vector>
 
 GLuint loadTextureFromFile(const char* path);
 GLuint createDefaultTexture(glm::vec3 color);
+GLuint createTextureArray(const std::vector<GLuint>& textures, int width, int height);
 #endif
\ No newline at end of file
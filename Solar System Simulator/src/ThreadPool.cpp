@@ -0,0 +1,110 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threadCount)
+    : currentTask(nullptr), currentCount(0), chunkCount(1), generation(0), pendingWorkers(0), stopping(false) {
+    setThreadCount(threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::setThreadCount(int threadCount) {
+    threadCount = max(1, threadCount);
+    if (threadCount == chunkCount && static_cast<int>(workers.size()) == threadCount - 1) return;
+
+    stopWorkers();
+    chunkCount = threadCount;
+    startWorkers(threadCount - 1);
+}
+
+int ThreadPool::getThreadCount() const {
+    return chunkCount;
+}
+
+int ThreadPool::getHardwareThreads() {
+    return max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+void ThreadPool::startWorkers(int workerCount) {
+    stopping = false;
+
+    // Chunk 0 is run by the calling thread, workers take chunks 1..workerCount
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i + 1, generation);
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        lock_guard<mutex> lock(poolMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int, int, int)>& task) {
+    if (count <= 0) return;
+
+    if (workers.empty()) {
+        task(0, count, 0);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(poolMutex);
+        currentTask = &task;
+        currentCount = count;
+        pendingWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    workReady.notify_all();
+
+    int firstEnd = static_cast<int>(static_cast<long long>(count) / chunkCount);
+    if (firstEnd > 0) {
+        task(0, firstEnd, 0);
+    }
+
+    unique_lock<mutex> lock(poolMutex);
+    workDone.wait(lock, [this] { return pendingWorkers == 0; });
+    currentTask = nullptr;
+}
+
+void ThreadPool::workerLoop(int chunk, int seenGeneration) {
+    while (true) {
+        const function<void(int, int, int)>* task;
+        int count;
+
+        {
+            unique_lock<mutex> lock(poolMutex);
+            workReady.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+
+            seenGeneration = generation;
+            task = currentTask;
+            count = currentCount;
+        }
+
+        // Same split for every call with the same thread count
+        int begin = static_cast<int>(static_cast<long long>(count) * chunk / chunkCount);
+        int end = static_cast<int>(static_cast<long long>(count) * (chunk + 1) / chunkCount);
+
+        if (end > begin) {
+            (*task)(begin, end, chunk);
+        }
+
+        {
+            lock_guard<mutex> lock(poolMutex);
+            pendingWorkers--;
+        }
+        workDone.notify_one();
+    }
+}
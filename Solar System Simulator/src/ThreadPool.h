@@ -0,0 +1,46 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+// Persistent worker threads for splitting a loop across cores.
+// Work is always split into the same contiguous chunks for a given thread count, so results are reproducible
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount = 1);
+    ~ThreadPool();
+
+    // Total threads taking part in parallelFor, including the calling thread
+    void setThreadCount(int threadCount);
+    int getThreadCount() const;
+
+    // Runs task(begin, end, chunk) over [0, count) split into one chunk per thread and waits for all of them
+    void parallelFor(int count, const function<void(int, int, int)>& task);
+
+    static int getHardwareThreads();
+
+private:
+    vector<thread> workers;
+    mutex poolMutex;
+    condition_variable workReady;
+    condition_variable workDone;
+
+    const function<void(int, int, int)>* currentTask;
+    int currentCount;
+    int chunkCount;
+    int generation;
+    int pendingWorkers;
+    bool stopping;
+
+    void startWorkers(int workerCount);
+    void stopWorkers();
+    void workerLoop(int chunk, int seenGeneration);
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef TRAJECTORYFORMAT_H
+#define TRAJECTORYFORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Layout of a recorded trajectory file, written by TrajectoryRecorder.
+//   header | body ids (int32) | body names (32 bytes each) | chunk 0 | chunk 1 | ...
+// Every chunk holds framesPerChunk frames as columns: the frame times, then x, y, z, vx, vy, vz
+// of every body, frame after frame. All values are doubles whatever the physics precision.
+// Chunks are padded to 8 bytes so the columns can be read in place through a mapping
+
+const char TRAJECTORY_MAGIC[8] = { 'S', 'S', 'S', 'T', 'R', 'A', 'J', 'C' };
+const unsigned int TRAJECTORY_VERSION = 1;
+const int TRAJECTORY_NAME_LENGTH = 32;
+
+enum TrajectoryColumn {
+    COLUMN_X = 0,
+    COLUMN_Y = 1,
+    COLUMN_Z = 2,
+    COLUMN_VX = 3,
+    COLUMN_VY = 4,
+    COLUMN_VZ = 5,
+    COLUMN_COUNT = 6
+};
+
+struct TrajectoryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t bodyCount;
+    uint32_t framesPerChunk;
+    uint64_t frameCount;    // Frames that are completely written, updated after each chunk
+    uint64_t chunkCapacity; // Chunks the file has room for
+    uint32_t sampleInterval; // Physics steps between frames
+    uint32_t padding;
+};
+
+inline size_t trajectoryPadded(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+inline size_t trajectoryIdsOffset() {
+    return trajectoryPadded(sizeof(TrajectoryHeader));
+}
+
+inline size_t trajectoryNamesOffset(size_t bodyCount) {
+    return trajectoryIdsOffset() + trajectoryPadded(bodyCount * sizeof(int32_t));
+}
+
+inline size_t trajectoryChunksOffset(size_t bodyCount) {
+    return trajectoryNamesOffset(bodyCount) + trajectoryPadded(bodyCount * TRAJECTORY_NAME_LENGTH);
+}
+
+// Doubles in one chunk: the time column and one column per state value
+inline size_t trajectoryChunkValues(size_t bodyCount, size_t framesPerChunk) {
+    return framesPerChunk + COLUMN_COUNT * framesPerChunk * bodyCount;
+}
+
+// Index of a value inside a chunk, in doubles
+inline size_t trajectoryTimeIndex(size_t frameInChunk) {
+    return frameInChunk;
+}
+
+inline size_t trajectoryValueIndex(size_t bodyCount, size_t framesPerChunk, int column, size_t frameInChunk, size_t body) {
+    return framesPerChunk + (column * framesPerChunk + frameInChunk) * bodyCount + body;
+}
+
+inline size_t trajectoryFileSize(size_t bodyCount, size_t framesPerChunk, size_t chunks) {
+    return trajectoryChunksOffset(bodyCount) + chunks * trajectoryChunkValues(bodyCount, framesPerChunk) * sizeof(double);
+}
+
+#endif
\ No newline at end of file
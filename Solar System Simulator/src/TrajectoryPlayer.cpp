@@ -0,0 +1,134 @@
+#include "TrajectoryPlayer.h"
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+TrajectoryPlayer::TrajectoryPlayer() : time(0.0), speed(1.0), paused(false), lastFrame(-1), jumped(true) {}
+
+bool TrajectoryPlayer::open(const string& path, const vector<CelestialBody*>& bodies) {
+    close();
+    if (!reader.open(path)) return false;
+
+    int matched = 0;
+    fileBodies.resize(bodies.size());
+    for (size_t i = 0; i < bodies.size(); i++) {
+        fileBodies[i] = reader.findBodyById(bodies[i]->id);
+        if (fileBodies[i] >= 0) matched++;
+    }
+
+    // Only the scene's own bodies can be shown, a recording of another scene would lose most of its bodies
+    int recorded = reader.getBodyCount();
+    if (matched == 0 || matched * 2 < recorded) {
+        cout << "Only " << matched << " of the " << recorded << " recorded bodies are in the scene, "
+             << "the recording is of a different scene" << endl;
+        close();
+        return false;
+    }
+    if (matched < recorded) {
+        cout << recorded - matched << " of the " << recorded << " recorded bodies aren't in the scene and won't be shown" << endl;
+    }
+
+    time = reader.getStartTime();
+    paused = false;
+    jumped = true;
+    return true;
+}
+
+void TrajectoryPlayer::close() {
+    reader.close();
+    fileBodies.clear();
+    lastFrame = -1;
+}
+
+bool TrajectoryPlayer::isOpen() const {
+    return reader.isOpen();
+}
+
+void TrajectoryPlayer::advance(double realDelta) {
+    if (!isOpen() || paused) return;
+
+    time += realDelta * speed;
+
+    // Stop at the ends rather than wrap, so a scrub doesn't jump across the recording
+    if (time <= getStartTime() || time >= getEndTime()) {
+        time = glm::clamp(time, getStartTime(), getEndTime());
+        paused = true;
+    }
+}
+
+void TrajectoryPlayer::seek(double newTime) {
+    if (!isOpen()) return;
+
+    time = glm::clamp(newTime, getStartTime(), getEndTime());
+    jumped = true;
+}
+
+double TrajectoryPlayer::getTime() const {
+    return time;
+}
+
+double TrajectoryPlayer::getStartTime() const {
+    return reader.getStartTime();
+}
+
+double TrajectoryPlayer::getEndTime() const {
+    return reader.getEndTime();
+}
+
+void TrajectoryPlayer::setSpeed(double newSpeed) {
+    // Turning around restarts the trails, they show the path in the direction of playback
+    if ((newSpeed < 0.0) != (speed < 0.0)) jumped = true;
+    speed = newSpeed;
+}
+
+double TrajectoryPlayer::getSpeed() const {
+    return speed;
+}
+
+void TrajectoryPlayer::setPaused(bool pause) {
+    paused = pause;
+}
+
+bool TrajectoryPlayer::isPaused() const {
+    return paused;
+}
+
+void TrajectoryPlayer::apply(vector<CelestialBody*>& bodies) {
+    if (!isOpen()) return;
+
+    long long frame = reader.findFrame(time);
+    bool newFrame = frame != lastFrame;
+
+    if (jumped) {
+        for (auto& body : bodies) {
+            body->clearOrbit();
+        }
+    }
+
+    for (size_t i = 0; i < bodies.size(); i++) {
+        CelestialBody* body = bodies[i];
+        if (fileBodies[i] < 0) continue;
+
+        // The frame is looked up once above, only the bodies in the scene are interpolated
+        TrajectorySample state = reader.interpolate(fileBodies[i], frame, time);
+        body->renderPosition = glm::vec3(state.position);
+        body->renderVelocity = glm::vec3(state.velocity);
+        body->renderRadius = body->getRadius();
+        body->renderColor = body->color;
+        body->renderInShadow = false;
+        body->renderShadowIntensity = 1.0f;
+
+        // Spin follows the playback time so it runs backwards too
+        if (!body->isStatic()) {
+            body->renderRotationAngle = static_cast<float>(fmod(body->rotationSpeed * time, 360.0));
+        }
+
+        if (jumped || newFrame) {
+            body->addOrbitPoint(body->renderPosition);
+        }
+    }
+
+    lastFrame = frame;
+    jumped = false;
+}
@@ -0,0 +1,53 @@
+#ifndef TRAJECTORYPLAYER_H
+#define TRAJECTORYPLAYER_H
+
+#include <string>
+#include <vector>
+#include "TrajectoryReader.h"
+#include "CelestialBody.h"
+
+using namespace std;
+
+// Plays a recorded trajectory into the bodies' render state instead of running physics.
+// Only the frames around the playback time are read, so memory stays the same whatever the length of the
+// recording, and a frame only costs as much as the bodies in the scene, not the bodies in the file.
+// The bodies drawn are the scene's own, recorded bodies it doesn't have are not created
+class TrajectoryPlayer {
+public:
+    TrajectoryPlayer();
+
+    // Matches the recorded bodies to the scene by ID, bodies missing from the file stay where they are.
+    // Fails if fewer than half of the recorded bodies are in the scene, e.g. a recording of a generated scene
+    bool open(const string& path, const vector<CelestialBody*>& bodies);
+    void close();
+    bool isOpen() const;
+
+    // Moves the playback time by realDelta seconds at the current speed, playback stops at either end
+    void advance(double realDelta);
+
+    void seek(double time);
+    double getTime() const;
+    double getStartTime() const;
+    double getEndTime() const;
+
+    // Simulated seconds per real second, negative plays backwards
+    void setSpeed(double newSpeed);
+    double getSpeed() const;
+
+    void setPaused(bool pause);
+    bool isPaused() const;
+
+    // Writes the state at the playback time into the bodies, trails grow with every recorded frame passed
+    void apply(vector<CelestialBody*>& bodies);
+
+private:
+    TrajectoryReader reader;
+    vector<int> fileBodies; // Index in the file of every scene body, -1 if it wasn't recorded
+    double time;
+    double speed;
+    bool paused;
+    long long lastFrame; // Frame the trails last grew from
+    bool jumped;         // Trails restart after a seek
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "TrajectoryReader.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+TrajectoryReader::TrajectoryReader() {
+    memset(&header, 0, sizeof(header));
+}
+
+bool TrajectoryReader::open(const string& path) {
+    close();
+
+    if (!file.openRead(path) || file.size() < sizeof(TrajectoryHeader)) {
+        close();
+        return false;
+    }
+
+    memcpy(&header, file.data(), sizeof(header));
+
+    bool valid = memcmp(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic)) == 0 && header.version == TRAJECTORY_VERSION &&
+                 header.headerSize == sizeof(TrajectoryHeader) && header.framesPerChunk > 0 && header.frameCount > 0;
+
+    // Every frame the header claims has to be inside the file
+    long long chunks = valid ? (header.frameCount + header.framesPerChunk - 1) / header.framesPerChunk : 0;
+    if (!valid || file.size() < trajectoryFileSize(header.bodyCount, header.framesPerChunk, chunks)) {
+        close();
+        return false;
+    }
+
+    chunkStartTimes.resize(chunks);
+    for (long long c = 0; c < chunks; c++) {
+        chunkStartTimes[c] = chunk(c)[trajectoryTimeIndex(0)];
+    }
+    return true;
+}
+
+void TrajectoryReader::close() {
+    file.close();
+    chunkStartTimes.clear();
+    memset(&header, 0, sizeof(header));
+}
+
+bool TrajectoryReader::isOpen() const {
+    return file.isOpen();
+}
+
+int TrajectoryReader::getBodyCount() const {
+    return static_cast<int>(header.bodyCount);
+}
+
+long long TrajectoryReader::getFrameCount() const {
+    return static_cast<long long>(header.frameCount);
+}
+
+int TrajectoryReader::getSampleInterval() const {
+    return static_cast<int>(header.sampleInterval);
+}
+
+double TrajectoryReader::getStartTime() const {
+    return getFrameTime(0);
+}
+
+double TrajectoryReader::getEndTime() const {
+    return getFrameTime(getFrameCount() - 1);
+}
+
+int TrajectoryReader::findBody(const string& name) const {
+    for (int body = 0; body < getBodyCount(); body++) {
+        if (getBodyName(body) == name) return body;
+    }
+    return -1;
+}
+
+int TrajectoryReader::findBodyById(int id) const {
+    for (int body = 0; body < getBodyCount(); body++) {
+        if (getBodyId(body) == id) return body;
+    }
+    return -1;
+}
+
+string TrajectoryReader::getBodyName(int body) const {
+    const char* name = file.data() + trajectoryNamesOffset(header.bodyCount) + body * TRAJECTORY_NAME_LENGTH;
+    return string(name, strnlen(name, TRAJECTORY_NAME_LENGTH));
+}
+
+int TrajectoryReader::getBodyId(int body) const {
+    int32_t id;
+    memcpy(&id, file.data() + trajectoryIdsOffset() + body * sizeof(int32_t), sizeof(id));
+    return id;
+}
+
+const double* TrajectoryReader::chunk(long long chunkIndex) const {
+    size_t chunkBytes = trajectoryChunkValues(header.bodyCount, header.framesPerChunk) * sizeof(double);
+    return reinterpret_cast<const double*>(file.data() + trajectoryChunksOffset(header.bodyCount) + chunkIndex * chunkBytes);
+}
+
+double TrajectoryReader::getFrameTime(long long frame) const {
+    return chunk(frame / header.framesPerChunk)[trajectoryTimeIndex(frame % header.framesPerChunk)];
+}
+
+double TrajectoryReader::value(long long frame, int column, int body) const {
+    size_t frameInChunk = frame % header.framesPerChunk;
+    return chunk(frame / header.framesPerChunk)[trajectoryValueIndex(header.bodyCount, header.framesPerChunk, column, frameInChunk, body)];
+}
+
+glm::dvec3 TrajectoryReader::vectorAt(long long frame, int firstColumn, int body) const {
+    return glm::dvec3(value(frame, firstColumn, body), value(frame, firstColumn + 1, body), value(frame, firstColumn + 2, body));
+}
+
+long long TrajectoryReader::findFrame(double time) const {
+    if (chunkStartTimes.empty() || time <= chunkStartTimes.front()) return 0;
+
+    // Last chunk starting at or before the time, then the last frame in it
+    long long chunkIndex = (upper_bound(chunkStartTimes.begin(), chunkStartTimes.end(), time) - chunkStartTimes.begin()) - 1;
+    long long first = chunkIndex * header.framesPerChunk;
+    long long framesInChunk = min(static_cast<long long>(header.framesPerChunk), getFrameCount() - first);
+
+    const double* times = chunk(chunkIndex);
+    long long frameInChunk = (upper_bound(times, times + framesInChunk, time) - times) - 1;
+
+    return first + frameInChunk;
+}
+
+TrajectorySample TrajectoryReader::getFrame(int body, long long frame) const {
+    TrajectorySample result;
+    result.time = getFrameTime(frame);
+    result.position = vectorAt(frame, COLUMN_X, body);
+    result.velocity = vectorAt(frame, COLUMN_VX, body);
+    return result;
+}
+
+// Cubic Hermite between 'frame' and the next one, matching position and velocity at both
+TrajectorySample TrajectoryReader::interpolate(int body, long long frame, double time) const {
+    if (frame + 1 >= getFrameCount()) return getFrame(body, frame);
+
+    TrajectorySample a = getFrame(body, frame);
+    TrajectorySample b = getFrame(body, frame + 1);
+
+    double h = b.time - a.time;
+    if (h <= 0.0) return a;
+
+    double s = glm::clamp((time - a.time) / h, 0.0, 1.0);
+    double s2 = s * s;
+    double s3 = s2 * s;
+
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    double h10 = s3 - 2.0 * s2 + s;
+    double h01 = -2.0 * s3 + 3.0 * s2;
+    double h11 = s3 - s2;
+
+    // Derivatives of the basis with respect to s, divided by h for the velocity
+    double d00 = 6.0 * s2 - 6.0 * s;
+    double d10 = 3.0 * s2 - 4.0 * s + 1.0;
+    double d01 = -6.0 * s2 + 6.0 * s;
+    double d11 = 3.0 * s2 - 2.0 * s;
+
+    TrajectorySample result;
+    result.time = a.time + s * h;
+    result.position = h00 * a.position + h10 * h * a.velocity + h01 * b.position + h11 * h * b.velocity;
+    result.velocity = (d00 * a.position + d01 * b.position) / h + d10 * a.velocity + d11 * b.velocity;
+    return result;
+}
+
+TrajectorySample TrajectoryReader::sample(int body, double time) const {
+    return interpolate(body, findFrame(time), time);
+}
+
+void TrajectoryReader::sampleRange(int body, double begin, double end, int count, vector<TrajectorySample>& samples) const {
+    samples.clear();
+    if (count <= 0) return;
+
+    samples.reserve(count);
+    for (int i = 0; i < count; i++) {
+        double time = count == 1 ? begin : begin + (end - begin) * i / (count - 1);
+        samples.push_back(sample(body, time));
+    }
+}
+
+void TrajectoryReader::sampleAll(double time, vector<glm::dvec3>& positions, vector<glm::dvec3>* velocities) const {
+    int count = getBodyCount();
+    long long frame = findFrame(time);
+
+    positions.resize(count);
+    if (velocities) velocities->resize(count);
+
+    for (int body = 0; body < count; body++) {
+        TrajectorySample state = interpolate(body, frame, time);
+        positions[body] = state.position;
+        if (velocities) (*velocities)[body] = state.velocity;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef TRAJECTORYREADER_H
+#define TRAJECTORYREADER_H
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MappedFile.h"
+#include "TrajectoryFormat.h"
+
+using namespace std;
+
+// State of one body at one time
+struct TrajectorySample {
+    double time;
+    glm::dvec3 position;
+    glm::dvec3 velocity;
+};
+
+// Reads a recorded trajectory file in place through a read-only mapping, only the pages a query touches are loaded.
+// Lookups by time are a binary search over the first time of every chunk, kept in memory, then over the
+// times inside one chunk. States between frames are cubic Hermite interpolated from the positions and velocities
+class TrajectoryReader {
+public:
+    TrajectoryReader();
+
+    bool open(const string& path);
+    void close();
+    bool isOpen() const;
+
+    int getBodyCount() const;
+    long long getFrameCount() const;
+    int getSampleInterval() const;
+    double getStartTime() const;
+    double getEndTime() const;
+
+    // Body index in the file, -1 if it wasn't recorded
+    int findBody(const string& name) const;
+    int findBodyById(int id) const;
+    string getBodyName(int body) const;
+    int getBodyId(int body) const;
+
+    double getFrameTime(long long frame) const;
+    // Last frame at or before 'time', clamped to the recorded frames
+    long long findFrame(double time) const;
+
+    // Recorded state of a body, exact at a frame
+    TrajectorySample getFrame(int body, long long frame) const;
+
+    // Interpolated state at any time, clamped to the recorded span
+    TrajectorySample sample(int body, double time) const;
+    // Same with the frame already looked up, for sampling many bodies at one time
+    TrajectorySample interpolate(int body, long long frame, double time) const;
+
+    // 'count' evenly spaced samples from 'begin' to 'end', e.g. for plotting
+    void sampleRange(int body, double begin, double end, int count, vector<TrajectorySample>& samples) const;
+
+    // Interpolated positions of every body at once, for drawing. Velocities too if asked for
+    void sampleAll(double time, vector<glm::dvec3>& positions, vector<glm::dvec3>* velocities = nullptr) const;
+
+private:
+    MappedFile file;
+    TrajectoryHeader header;
+    vector<double> chunkStartTimes; // Time index, one entry per chunk
+
+    const double* chunk(long long chunkIndex) const;
+    double value(long long frame, int column, int body) const;
+    glm::dvec3 vectorAt(long long frame, int firstColumn, int body) const;
+};
+
+#endif
\ No newline at end of file
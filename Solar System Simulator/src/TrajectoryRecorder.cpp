@@ -0,0 +1,218 @@
+#include "TrajectoryRecorder.h"
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+TrajectoryRecorder::TrajectoryRecorder()
+    : bodyCount(0), framesPerChunk(0), sampleInterval(1), stepCounter(0), recordedFrames(0), droppedFrames(0), writeFailed(false), dropWhenBehind(true),
+      filling(0), framesInChunk(0), nextChunk(0), inFlight(-1), inFlightChunk(0), stopping(false) {}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    close();
+}
+
+bool TrajectoryRecorder::open(const string& path, const BodyStore& store, const vector<CelestialBody*>& bodies, int interval,
+                              long long expectedFrames, bool dropFrames, int chunkFrames) {
+    close();
+
+    dropWhenBehind = dropFrames;
+    bodyCount = store.size();
+    framesPerChunk = max(1, chunkFrames);
+    sampleInterval = max(1, interval);
+
+    long long expectedChunks = max(1LL, (expectedFrames + framesPerChunk - 1) / framesPerChunk);
+    if (!file.create(path, trajectoryFileSize(bodyCount, framesPerChunk, expectedChunks))) {
+        cout << "Could not create trajectory file " << path << endl;
+        return false;
+    }
+
+    char* data = file.data();
+
+    TrajectoryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRAJECTORY_MAGIC, sizeof(header.magic));
+    header.version = TRAJECTORY_VERSION;
+    header.headerSize = sizeof(TrajectoryHeader);
+    header.bodyCount = bodyCount;
+    header.framesPerChunk = framesPerChunk;
+    header.frameCount = 0;
+    header.chunkCapacity = expectedChunks;
+    header.sampleInterval = sampleInterval;
+    memcpy(data, &header, sizeof(header));
+
+    int32_t* ids = reinterpret_cast<int32_t*>(data + trajectoryIdsOffset());
+    char* names = data + trajectoryNamesOffset(bodyCount);
+
+    for (int i = 0; i < bodyCount; i++) {
+        ids[i] = store.ids[i];
+
+        // Fixed width, cut off if longer
+        char* name = names + i * TRAJECTORY_NAME_LENGTH;
+        memset(name, 0, TRAJECTORY_NAME_LENGTH);
+        if (i < static_cast<int>(bodies.size())) {
+            memcpy(name, bodies[i]->name.c_str(), min(bodies[i]->name.size(), static_cast<size_t>(TRAJECTORY_NAME_LENGTH - 1)));
+        }
+    }
+
+    size_t chunkValues = trajectoryChunkValues(bodyCount, framesPerChunk);
+    chunks[0].assign(chunkValues, 0.0);
+    chunks[1].assign(chunkValues, 0.0);
+
+    stepCounter = 0;
+    recordedFrames = 0;
+    droppedFrames = 0;
+    writeFailed = false;
+    filling = 0;
+    framesInChunk = 0;
+    nextChunk = 0;
+    inFlight = -1;
+    stopping = false;
+
+    writer = thread(&TrajectoryRecorder::writerLoop, this);
+    return true;
+}
+
+void TrajectoryRecorder::close() {
+    if (!file.isOpen()) return;
+
+    {
+        lock_guard<mutex> lock(handoverMutex);
+        stopping = true;
+    }
+    handover.notify_one();
+    if (writer.joinable()) writer.join();
+
+    // The writer is gone, the partly filled chunk is written from here
+    if (framesInChunk > 0 && !writeChunk(chunks[filling], nextChunk, framesInChunk)) {
+        writeFailed = true;
+    }
+    if (framesInChunk > 0) nextChunk++;
+
+    // Room preallocated but never used is given back
+    TrajectoryHeader* header = reinterpret_cast<TrajectoryHeader*>(file.data());
+    long long usedChunks = max(1LL, nextChunk);
+    if (static_cast<long long>(header->chunkCapacity) > usedChunks && file.resize(trajectoryFileSize(bodyCount, framesPerChunk, usedChunks))) {
+        reinterpret_cast<TrajectoryHeader*>(file.data())->chunkCapacity = usedChunks;
+    }
+
+    if (writeFailed) cout << "Trajectory file could not be written completely" << endl;
+    if (droppedFrames > 0) cout << "Trajectory recorder dropped " << droppedFrames << " frames" << endl;
+
+    file.close();
+
+    chunks[0] = vector<double>();
+    chunks[1] = vector<double>();
+}
+
+void TrajectoryRecorder::recordStep(const BodyStore& store, double simulationTime) {
+    if (!file.isOpen()) return;
+
+    stepCounter++;
+    if (stepCounter % sampleInterval == 0) recordFrame(store, simulationTime);
+}
+
+void TrajectoryRecorder::recordFrame(const BodyStore& store, double simulationTime) {
+    if (!file.isOpen() || store.size() != bodyCount) return;
+
+    double* chunk = chunks[filling].data();
+    size_t frame = framesInChunk;
+
+    chunk[trajectoryTimeIndex(frame)] = simulationTime;
+
+    // Each column of a frame is contiguous
+    const PhysicsReal* columns[COLUMN_COUNT] = { store.x.data(), store.y.data(), store.z.data(), store.vx.data(), store.vy.data(), store.vz.data() };
+    for (int column = 0; column < COLUMN_COUNT; column++) {
+        double* out = chunk + trajectoryValueIndex(bodyCount, framesPerChunk, column, frame, 0);
+        const PhysicsReal* in = columns[column];
+
+        for (int i = 0; i < bodyCount; i++) {
+            out[i] = in[i];
+        }
+    }
+
+    recordedFrames++;
+    framesInChunk++;
+    if (framesInChunk == framesPerChunk) handOver();
+}
+
+// Gives the full chunk to the writer and carries on in the other one
+void TrajectoryRecorder::handOver() {
+    {
+        unique_lock<mutex> lock(handoverMutex);
+
+        if (inFlight >= 0 && !dropWhenBehind) {
+            writerIdle.wait(lock, [this]() { return inFlight < 0; });
+        }
+
+        if (inFlight >= 0) {
+            // The writer still has the other buffer, this chunk is lost
+            droppedFrames += framesInChunk;
+            recordedFrames -= framesInChunk;
+            framesInChunk = 0;
+            return;
+        }
+
+        inFlight = filling;
+        inFlightChunk = nextChunk;
+    }
+    handover.notify_one();
+
+    filling = 1 - filling;
+    framesInChunk = 0;
+    nextChunk++;
+}
+
+void TrajectoryRecorder::writerLoop() {
+    unique_lock<mutex> lock(handoverMutex);
+
+    while (true) {
+        handover.wait(lock, [this]() { return inFlight >= 0 || stopping; });
+        if (inFlight < 0) return;
+
+        int buffer = inFlight;
+        long long chunkIndex = inFlightChunk;
+
+        // The copy into the mapping is what may wait on the disk, so it happens unlocked
+        lock.unlock();
+        bool written = writeChunk(chunks[buffer], chunkIndex, framesPerChunk);
+        lock.lock();
+
+        if (!written) writeFailed = true;
+        inFlight = -1;
+        writerIdle.notify_one();
+    }
+}
+
+bool TrajectoryRecorder::writeChunk(const vector<double>& chunk, long long chunkIndex, int frames) {
+    TrajectoryHeader* header = reinterpret_cast<TrajectoryHeader*>(file.data());
+
+    // Past the preallocated room, double the file
+    if (chunkIndex >= static_cast<long long>(header->chunkCapacity)) {
+        long long capacity = max(chunkIndex + 1, static_cast<long long>(header->chunkCapacity) * 2);
+        if (!file.resize(trajectoryFileSize(bodyCount, framesPerChunk, capacity))) return false;
+
+        header = reinterpret_cast<TrajectoryHeader*>(file.data());
+        header->chunkCapacity = capacity;
+    }
+
+    size_t chunkBytes = chunk.size() * sizeof(double);
+    memcpy(file.data() + trajectoryChunksOffset(bodyCount) + chunkIndex * chunkBytes, chunk.data(), chunkBytes);
+
+    // Readers only trust frames up to here
+    header->frameCount = static_cast<uint64_t>(chunkIndex) * framesPerChunk + frames;
+    return true;
+}
+
+bool TrajectoryRecorder::isOpen() const {
+    return file.isOpen();
+}
+
+long long TrajectoryRecorder::getRecordedFrames() const {
+    return recordedFrames;
+}
+
+long long TrajectoryRecorder::getDroppedFrames() const {
+    return droppedFrames;
+}
@@ -0,0 +1,73 @@
+#ifndef TRAJECTORYRECORDER_H
+#define TRAJECTORYRECORDER_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "BodyStore.h"
+#include "CelestialBody.h"
+#include "MappedFile.h"
+#include "TrajectoryFormat.h"
+
+using namespace std;
+
+// Streams the state of every body into a memory-mapped trajectory file (see TrajectoryFormat.h).
+// The physics thread fills one chunk in memory while a writer thread copies the other into the file,
+// so recording doesn't wait on the disk. If the writer falls a whole chunk behind, the chunk is either dropped
+// and counted, for interactive use, or the recorder waits for the writer, for batch runs that need every frame
+class TrajectoryRecorder {
+public:
+    TrajectoryRecorder();
+    ~TrajectoryRecorder();
+
+    // Preallocates room for 'expectedFrames', the file grows past that if needed.
+    // One frame is taken every 'sampleInterval' calls to recordStep
+    bool open(const string& path, const BodyStore& store, const vector<CelestialBody*>& bodies, int sampleInterval,
+              long long expectedFrames, bool dropWhenBehind, int framesPerChunk = 256);
+
+    // Writes what is still in memory and trims the file to the recorded frames
+    void close();
+
+    // Call after every physics step
+    void recordStep(const BodyStore& store, double simulationTime);
+    // Records the current state whatever the interval, e.g. the starting state
+    void recordFrame(const BodyStore& store, double simulationTime);
+
+    bool isOpen() const;
+    long long getRecordedFrames() const;
+    long long getDroppedFrames() const;
+
+private:
+    MappedFile file;
+    int bodyCount;
+    int framesPerChunk;
+    int sampleInterval;
+    long long stepCounter;
+    long long recordedFrames;
+    long long droppedFrames;
+    bool writeFailed;
+    bool dropWhenBehind;
+
+    // Filled by the physics thread
+    vector<double> chunks[2];
+    int filling;
+    int framesInChunk;
+    long long nextChunk; // Position in the file of the chunk being filled
+
+    // Handover to the writer thread
+    thread writer;
+    mutex handoverMutex;
+    condition_variable handover;
+    condition_variable writerIdle;
+    int inFlight;        // Chunk buffer the writer owns, -1 while it is idle
+    long long inFlightChunk;
+    bool stopping;
+
+    void handOver();
+    void writerLoop();
+    bool writeChunk(const vector<double>& chunk, long long chunkIndex, int frames);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+using namespace std;
+
+// Lock-free handoff of the latest value from one writer thread to one reader thread.
+// The writer fills its own buffer and swaps it into the middle slot; the reader swaps the middle slot out
+// when it holds something newer. Neither side ever waits and the reader always sees a complete value
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : writeIndex(0), readIndex(2), middle(1) {}
+
+    // Writer side
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        unsigned int previous = middle.exchange(writeIndex | FRESH_BIT, memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side: picks up the newest published value, returns false if there was nothing new
+    bool update() {
+        if (!(middle.load(memory_order_acquire) & FRESH_BIT)) return false;
+
+        unsigned int previous = middle.exchange(readIndex, memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const unsigned int INDEX_MASK = 3;
+    static const unsigned int FRESH_BIT = 4; // Set while the middle slot has not been read yet
+
+    T buffers[3];
+    unsigned int writeIndex;
+    unsigned int readIndex;
+    atomic<unsigned int> middle;
+};
+
+#endif
\ No newline at end of file